@@ -0,0 +1,128 @@
+#!/usr/bin/env python3
+"""Converts a text AiM packet trace into the binary format read by AiMPacketTrace.
+
+The binary trace (see src/frontend/impl/memory_trace/AiM_binary_trace.h) is a 64-byte header
+followed by one fixed-width 24-byte record per trace entry. AiMPacketTrace detects the format
+from the magic number and memory-maps the file instead of parsing it.
+
+Example:
+  python3 aim_trace_converter.py gemv.trace gemv.bin --org 16,1,4,4,131072,1024
+"""
+
+import argparse
+import re
+import struct
+import sys
+
+MAGIC = b"AIMTRACE"
+VERSION = 1
+MAX_LEVELS = 8
+HEADER_FORMAT = "<8sIIQII8i"
+RECORD_FORMAT = "<qIHHHHHbb"
+
+# Request type name -> (Request::Type id, number of banks), following AiMPacketTrace::init_trace()
+REQUEST_TYPES = {
+  "R":                (0,  -1),
+  "W":                (1,  -1),
+  "MAC_SBK":          (2,   1),
+  "AF_SBK":           (3,   1),
+  "COPY_BKGB":        (4,   1),
+  "COPY_GBBK":        (5,   1),
+  "MAC_4BK_INTRA_BG": (6,   4),
+  "AF_4BK_INTRA_BG":  (7,   4),
+  "EWMUL":            (8,   4),
+  "EWADD":            (9,   4),
+  "MAC_ABK":          (10, 16),
+  "AF_ABK":           (11, 16),
+  "WR_AFLUT":         (12, 16),
+  "WR_BK":            (13, 16),
+  "WR_GB":            (14,  0),
+  "WR_MAC":           (15,  0),
+  "WR_BIAS":          (16,  0),
+  "RD_MAC":           (17,  0),
+  "RD_AF":            (18,  0),
+  "MAC_4BK_INTER_BG": (19,  4),
+  "AF_4BK_INTER_BG":  (20,  4),
+}
+
+_LEADING_INT = re.compile(r"\s*[+-]?\d+")
+
+
+def to_int(token):
+  # Mimics std::stoi/std::stoll, which parse the leading decimal integer of the token
+  match = _LEADING_INT.match(token)
+  if match is None:
+    raise ValueError(f"invalid integer '{token}'")
+  return int(match.group())
+
+
+def convert_line(tokens):
+  if tokens[0] not in REQUEST_TYPES:
+    raise ValueError(f"unknown request type '{tokens[0]}'")
+  type_id, num_banks = REQUEST_TYPES[tokens[0]]
+
+  addr, row, ch_mask, rank, pch, bank, col = -1, 0, 0, 0, 0, 0, 0
+  if num_banks == -1:
+    addr = to_int(tokens[1])
+  elif num_banks == 0:
+    ch_mask = to_int(tokens[1]) & 0xFFFF
+  elif num_banks == 1:
+    ch_mask = to_int(tokens[1]) & 0xFFFF
+    addr = to_int(tokens[7])
+  else:
+    ch_mask = to_int(tokens[1]) & 0xFFFF
+    rank = to_int(tokens[2]) & 0xFFFF
+    pch = to_int(tokens[3]) & 0xFFFF
+    bank = to_int(tokens[4]) & 0xFFFF
+    row = to_int(tokens[5]) & 0xFFFFFFFF
+    col = to_int(tokens[6]) & 0xFFFF
+
+  return struct.pack(RECORD_FORMAT, addr, row, ch_mask, rank, pch, bank, col, type_id, num_banks)
+
+
+def pack_header(num_records, org):
+  level_counts = org + [0] * (MAX_LEVELS - len(org))
+  return struct.pack(HEADER_FORMAT, MAGIC, VERSION, struct.calcsize(RECORD_FORMAT),
+                     num_records, len(org), 0, *level_counts)
+
+
+def convert(text_path, binary_path, org):
+  num_records = 0
+  with open(text_path, "r") as text_file, open(binary_path, "wb") as binary_file:
+    # The number of records is patched in once the whole trace is converted
+    binary_file.write(pack_header(0, org))
+    for line_num, line in enumerate(text_file, 1):
+      if line.startswith("#"):
+        continue
+      tokens = line.split()
+      if not tokens:
+        continue
+      try:
+        binary_file.write(convert_line(tokens))
+      except (ValueError, IndexError) as e:
+        sys.exit(f"{text_path}:{line_num}: trace format invalid ({e})")
+      num_records += 1
+    binary_file.seek(0)
+    binary_file.write(pack_header(num_records, org))
+  return num_records
+
+
+def main():
+  parser = argparse.ArgumentParser(description="Convert a text AiM packet trace into the binary trace format.")
+  parser.add_argument("text_trace", help="Path to the text AiM packet trace")
+  parser.add_argument("binary_trace", help="Path to the binary trace to write")
+  parser.add_argument("--org", default="",
+                      help="Comma-separated level counts of the target device (e.g., 16,1,4,4,131072,1024 for "
+                           "16X_LPDDR5_AiM_32Gb_x16). AiMPacketTrace rejects the trace for any other organization.")
+  args = parser.parse_args()
+
+  org = [int(count) for count in args.org.split(",")] if args.org else []
+  if len(org) > MAX_LEVELS:
+    sys.exit(f"At most {MAX_LEVELS} organization levels are supported")
+
+  num_records = convert(args.text_trace, args.binary_trace, org)
+  print(f"Converted {num_records} records into {args.binary_trace}")
+
+
+if __name__ == "__main__":
+  main()
@@ -20,7 +20,13 @@ class IAddrMapper {
      */
     virtual void apply(Request& req) = 0;
 
-    virtual std::vector<Addr_t> convert_pkt_addr(const Trace& trace) = 0;
+    /**
+     * @brief  Expands an AiM packet into one address per channel in its channel mask
+     * @details
+     * The addresses are written into the given vector (cleared first) so that the caller can reuse its storage.
+     * 
+     */
+    virtual void convert_pkt_addr(const Trace& trace, std::vector<Addr_t>& addrs) = 0;
     virtual IDRAM* get_m_dram() = 0;
 };
 
@@ -0,0 +1,106 @@
+#ifndef     RAMULATOR_ADDR_MAPPER_AIM_LINEAR_MAPPER_H
+#define     RAMULATOR_ADDR_MAPPER_AIM_LINEAR_MAPPER_H
+
+#include <vector>
+
+#include "base/base.h"
+#include "addr_mapper/addr_mapper.h"
+#include "memory_system/memory_system.h"
+#include "frontend/frontend.h"
+
+namespace Ramulator {
+
+class LinearMapperBase : public IAddrMapper {
+  public:
+    IDRAM* m_dram = nullptr;
+    // How many levels in the hierarchy?
+    int m_num_levels = -1;
+    // How many address bits for each level in the hierarchy?
+    std::vector<int> m_addr_bits;
+    Addr_t m_tx_offset = -1;
+    int m_col_bits_idx = -1;
+    int m_row_bits_idx = -1;
+    // Level indices used to build the addresses of AiM packets (-1 if the level does not exist)
+    int m_ch_idx = -1;
+    int m_ra_idx = -1;
+    int m_pch_idx = -1;
+    int m_bg_idx = -1;
+    int m_ba_idx = -1;
+
+  protected:
+    void setup(IFrontEnd* frontend, IMemorySystem* memory_system) {
+      m_dram = memory_system->get_ifce<IDRAM>();
+
+      // Populate m_addr_bits vector with the number of address bits for each level in the hierachy
+      const auto& count = m_dram->m_organization.count;
+      m_num_levels = count.size();
+      m_addr_bits.resize(m_num_levels);
+      for (size_t level = 0; level < m_addr_bits.size(); level++) {
+        m_addr_bits[level] = calc_log2(count[level]);
+      }
+
+      // Last (Column) address have the granularity of the prefetch size
+      m_addr_bits[m_num_levels - 1] -= calc_log2(m_dram->m_internal_prefetch_size);
+
+      int tx_bytes = m_dram->m_internal_prefetch_size * m_dram->m_channel_width / 8;
+      m_tx_offset = calc_log2(tx_bytes);
+
+      // Determine where are the row and col bits for ChRaBaRoCo and RoBaRaCoCh
+      try {
+        m_row_bits_idx = m_dram->m_levels("row");
+      } catch (const std::out_of_range& r) {
+        throw std::runtime_error(fmt::format("Organization \"row\" not found in the spec, cannot use linear mapping!"));
+      }
+
+      // Assume column is always the last level
+      m_col_bits_idx = m_num_levels - 1;
+
+      m_ch_idx = m_dram->m_levels("channel");
+      m_ra_idx = m_dram->m_levels.contains("rank") ? m_dram->m_levels("rank") : -1;
+      m_pch_idx = m_dram->m_levels.contains("pseudochannel") ? m_dram->m_levels("pseudochannel") : -1;
+      m_bg_idx = m_dram->m_levels("bankgroup");
+      m_ba_idx = m_dram->m_levels("bank");
+    }
+
+    /**
+     * @brief    Splits the bank mask of an inter-bankgroup AiM packet into the bank ids it selects.
+     * @details
+     * The mask has one bit per bank (bankgroup-major, like the bank field of the other packets). An
+     * inter-bankgroup command operates on the same bank of every bankgroup, so each bank id must be
+     * selected in either all or none of the bankgroups.
+     */
+    void convert_inter_bg_mask(uint16_t mask, std::vector<int>& bank_ids) {
+      int num_bgs = 1 << m_addr_bits[m_bg_idx];
+      int num_banks = 1 << m_addr_bits[m_ba_idx];
+      for (int bank_id = 0; bank_id < num_banks; bank_id++) {
+        int num_selected_bgs = 0;
+        for (int bg_id = 0; bg_id < num_bgs; bg_id++) {
+          num_selected_bgs += (mask >> (bg_id * num_banks + bank_id)) & 1;
+        }
+        if (num_selected_bgs == num_bgs) {
+          bank_ids.push_back(bank_id);
+        } else if (num_selected_bgs != 0) {
+          throw ConfigurationError("Inter-bankgroup AiM bank mask 0x{:x} must select bank {} in all or none of the {} bankgroups!", mask, bank_id, num_bgs);
+        }
+      }
+      if (bank_ids.empty()) {
+        throw ConfigurationError("Inter-bankgroup AiM bank mask 0x{:x} selects no bank!", mask);
+      }
+    }
+
+    void set_inter_bg_bank_addrs(Request& req) {
+      int num_bgs = 1 << m_addr_bits[m_bg_idx];
+      int num_banks = 1 << m_addr_bits[m_ba_idx];
+      req.inter_bg_bank_addrs = 0;
+      for (int bg_id = 0; bg_id < num_bgs; bg_id++) {
+        req.inter_bg_bank_addrs |= (uint16_t) (1U << (bg_id * num_banks + req.addr_h[m_ba_idx]));
+      }
+    }
+
+    // Bankgroup + bank fields of the addresses of the AiM packet being converted
+    std::vector<int> m_bank_fields;
+};
+
+}        // namespace Ramulator
+
+#endif   // RAMULATOR_ADDR_MAPPER_AIM_LINEAR_MAPPER_H
@@ -1,67 +1,10 @@
 #include <vector>
 
 #include "base/base.h"
-#include "addr_mapper/addr_mapper.h"
-#include "memory_system/memory_system.h"
-#include "frontend/frontend.h"
+#include "addr_mapper/impl/AiM_linear_mapper.h"
 
 namespace Ramulator {
 
-class LinearMapperBase : public IAddrMapper {
-  public:
-    IDRAM* m_dram = nullptr;
-    // How many levels in the hierarchy?
-    int m_num_levels = -1;
-    // How many address bits for each level in the hierarchy?
-    std::vector<int> m_addr_bits;
-    Addr_t m_tx_offset = -1;
-    int m_col_bits_idx = -1;
-    int m_row_bits_idx = -1;
-
-  protected:
-    void setup(IFrontEnd* frontend, IMemorySystem* memory_system) {
-      m_dram = memory_system->get_ifce<IDRAM>();
-
-      // Populate m_addr_bits vector with the number of address bits for each level in the hierachy
-      const auto& count = m_dram->m_organization.count;
-      m_num_levels = count.size();
-      m_addr_bits.resize(m_num_levels);
-      for (size_t level = 0; level < m_addr_bits.size(); level++) {
-        m_addr_bits[level] = calc_log2(count[level]);
-      }
-
-      // Last (Column) address have the granularity of the prefetch size
-      m_addr_bits[m_num_levels - 1] -= calc_log2(m_dram->m_internal_prefetch_size);
-
-      int tx_bytes = m_dram->m_internal_prefetch_size * m_dram->m_channel_width / 8;
-      m_tx_offset = calc_log2(tx_bytes);
-
-      // Determine where are the row and col bits for ChRaBaRoCo and RoBaRaCoCh
-      try {
-        m_row_bits_idx = m_dram->m_levels("row");
-      } catch (const std::out_of_range& r) {
-        throw std::runtime_error(fmt::format("Organization \"row\" not found in the spec, cannot use linear mapping!"));
-      }
-
-      // Assume column is always the last level
-      m_col_bits_idx = m_num_levels - 1;
-    }
-
-    std::vector<int> convert_mask_to_id(Addr_t mask, int level) {
-      std::vector<int> addrs;
-      int bitwidth = 1U << (m_addr_bits[level]);
-      if (level == m_dram->m_levels("bank")) {
-        bitwidth = 1U << (m_addr_bits[m_dram->m_levels("bankgroup")] + m_addr_bits[m_dram->m_levels("bank")]);
-      }
-      for (int bit_pos = 0; bit_pos < bitwidth; bit_pos++) {
-        if (mask & (1U << bit_pos)) {
-          addrs.push_back(bit_pos);
-        }
-      }
-      return addrs;
-    }
-};
-
 class ChRaBaRoCo final : public LinearMapperBase, public Implementation {
   RAMULATOR_REGISTER_IMPLEMENTATION(IAddrMapper, ChRaBaRoCo, "ChRaBaRoCo", "Applies a trival mapping to the address.");
 
@@ -78,80 +21,65 @@ class ChRaBaRoCo final : public LinearMapperBase, public Implementation {
       for (int i = m_addr_bits.size() - 1; i >= 0; i--) {
         req.addr_h[i] = slice_lower_bits(addr, m_addr_bits[i]);
       }
+      if (req.is_inter_bg) {
+        set_inter_bg_bank_addrs(req);
+      }
     }
 
-    std::vector<Addr_t> convert_pkt_addr(const Trace& trace) override {
-      std::unordered_map<std::string_view, int> level_mem_hierarchy;
-      for (int i = 0; i < m_dram->m_levels.size(); i++) {
-        std::string_view level_name = m_dram->m_levels(i);
-        if (m_dram->m_levels.contains(level_name)) {
-          level_mem_hierarchy[level_name] = m_dram->m_levels(level_name);
-        }
+    void convert_pkt_addr(const Trace& trace, std::vector<Addr_t>& addrs) override {
+      addrs.clear();
+
+      // Bankgroup + Bank field(s) of the addresses: an intra-bankgroup packet addresses a single (bankgroup, bank),
+      // an inter-bankgroup packet is expanded to one address per bank id it selects in every bankgroup
+      m_bank_fields.clear();
+      if (trace.is_inter_bg) {
+        convert_inter_bg_mask(trace.bank_addr_or_mask, m_bank_fields);
+      } else {
+        uint16_t bank_mask = (1U << (m_addr_bits[m_bg_idx] + m_addr_bits[m_ba_idx])) - 1;
+        m_bank_fields.push_back(trace.bank_addr_or_mask & bank_mask);
       }
-      std::vector<int> ch_addrs = convert_mask_to_id(trace.ch_mask, level_mem_hierarchy["channel"]);
-      // uint16_t flat_bank_addrs = 0;
-      // std::vector<int> bank_addrs = convert_mask_to_id(trace.bank_addr_or_mask, level_mem_hierarchy["bank"]);
-      // TODO: Handle inter-bankgroup AiM cmds.
-      // if (trace.is_inter_bg) {
-      //   // Inter-bank AiM; for 4 bankgroups/channel * 4 banks/bankgroup
-      //   for (int i = 0; i < 4; i++) {
-      //     flat_bank_addrs |= bank_addrs[i];
-      //     flat_bank_addrs <<= 4;
-      //   }
-      // }
 
-      // Map the converted addresses to the single address
-      std::vector<Addr_t> addrs(ch_addrs.size(), 0);
-      for (size_t i = 0; i < ch_addrs.size(); i++) {
-        Addr_t addr = 0;
-
-        // Build address from MSB to LSB with proper masking:
-        //   Channel -> Rank -> Bank -> Row -> Column
-        // Channel
-        addr = ch_addrs[i] & ((1ULL << m_addr_bits[m_dram->m_levels("channel")]) - 1);
-        // Rank is optional
-        if (m_dram->m_levels.contains("rank") && trace.rank_addr != -1) {
-          addr <<= m_addr_bits[level_mem_hierarchy["rank"]];
-          uint16_t rank_mask = (1U << (m_addr_bits[level_mem_hierarchy["rank"]])) - 1;
-          addr |= (trace.rank_addr & rank_mask);
+      // Map each channel in the channel mask to a single address (per bank field)
+      int num_chs = 1U << m_addr_bits[m_ch_idx];
+      for (int ch_addr = 0; ch_addr < num_chs; ch_addr++) {
+        if (!(trace.ch_mask & (1U << ch_addr))) {
+          continue;
         }
-        // Pseudochannel is optional
-        if (m_dram->m_levels.contains("pseudochannel")) {
-          addr <<= m_addr_bits[level_mem_hierarchy["pseudochannel"]];
-          uint16_t pch_mask = (1U << (m_addr_bits[level_mem_hierarchy["pseudochannel"]])) - 1;
-          addr |= (trace.pch_addr & pch_mask);
+        for (int bank_field : m_bank_fields) {
+          Addr_t addr = 0;
+
+          // Build address from MSB to LSB with proper masking:
+          //   Channel -> Rank -> Bank -> Row -> Column
+          // Channel
+          addr = ch_addr & ((1ULL << m_addr_bits[m_ch_idx]) - 1);
+          // Rank is optional
+          if (m_ra_idx != -1) {
+            addr <<= m_addr_bits[m_ra_idx];
+            uint16_t rank_mask = (1U << (m_addr_bits[m_ra_idx])) - 1;
+            addr |= (trace.rank_addr & rank_mask);
+          }
+          // Pseudochannel is optional
+          if (m_pch_idx != -1) {
+            addr <<= m_addr_bits[m_pch_idx];
+            uint16_t pch_mask = (1U << (m_addr_bits[m_pch_idx])) - 1;
+            addr |= (trace.pch_addr & pch_mask);
+          }
+          // Bankgroup + Bank
+          addr <<= m_addr_bits[m_bg_idx] + m_addr_bits[m_ba_idx];
+          addr |= bank_field;
+          // Row
+          addr <<= m_addr_bits[m_row_bits_idx];
+          uint32_t row_mask = (1U << m_addr_bits[m_row_bits_idx]) - 1;
+          addr |= (trace.row_addr & row_mask);
+          // Col
+          addr <<= m_addr_bits[m_col_bits_idx];
+          uint16_t col_mask = (1U << m_addr_bits[m_col_bits_idx]) - 1;
+          addr |= (trace.col_addr & col_mask);
+
+          addr <<= m_tx_offset;
+          addrs.push_back(addr);
         }
-        // Bankgroup + Bank
-        addr <<= m_addr_bits[level_mem_hierarchy["bankgroup"]] + m_addr_bits[level_mem_hierarchy["bank"]];
-        uint16_t bank_mask = (1U << (m_addr_bits[level_mem_hierarchy["bankgroup"]] + m_addr_bits[level_mem_hierarchy["bank"]])) - 1;
-        // TODO: Handle inter-bankgroup AiM cmds.
-        // if (trace.is_inter_bg) {
-        //   // 61440(=0xf000) for masking bank_addrs[0]
-        //   bank_mask = 61440U;
-        // } else {
-        // }
-        addr |= (trace.bank_addr_or_mask & bank_mask);
-        // Row
-        addr <<= m_addr_bits[m_row_bits_idx];
-        uint32_t row_mask = (1U << m_addr_bits[m_row_bits_idx]) - 1;
-        addr |= (trace.row_addr & row_mask);
-        // Col
-        addr <<= m_addr_bits[m_col_bits_idx];
-        uint16_t col_mask = (1U << m_addr_bits[m_col_bits_idx]) - 1;
-        addr |= (trace.col_addr & col_mask);
-
-        addr <<= m_tx_offset;
-        addrs[i] = addr;
-
-        /* TODO
-         * - Mask bank_addrs to addrs (return value) to assign
-         *   Request.integer_bg_bank_addrs for INTER_BG AiM cmds.
-         */
-        // if (trace.is_inter_bg) {
-        //   addrs[i]
-        // }
       }
-      return addrs;
     }
 
     IDRAM* get_m_dram() override {
@@ -177,19 +105,29 @@ class RoBaRaCoCh final : public LinearMapperBase, public Implementation {
       for (int i = 1; i <= m_row_bits_idx; i++) {
         req.addr_h[i] = slice_lower_bits(addr, m_addr_bits[i]);
       }
+      if (req.is_inter_bg) {
+        set_inter_bg_bank_addrs(req);
+      }
     }
 
-    std::vector<Addr_t> convert_pkt_addr(const Trace& trace) override {
+    void convert_pkt_addr(const Trace& trace, std::vector<Addr_t>& addrs) override {
+      if (trace.is_inter_bg) {
+        throw ConfigurationError("RoBaRaCoCh: inter-bankgroup AiM bank masks are not supported!");
+      }
+
       // For RoBaRaCoCh mapping, implement similar logic to ChRaBaRoCo
       // but with different address bit ordering
-      std::vector<int> ch_addrs = convert_mask_to_id(trace.ch_mask, 0);
-      std::vector<Addr_t> addrs(ch_addrs.size(), 0);
+      addrs.clear();
 
       // TODO: Implement RoBaRaCoCh-specific address conversion logic
       // This is a placeholder implementation - you may need to adjust
       // based on your specific RoBaRaCoCh mapping requirements
       
-      for (size_t i = 0; i < ch_addrs.size(); i++) {
+      int num_chs = 1U << m_addr_bits[m_ch_idx];
+      for (int ch_addr = 0; ch_addr < num_chs; ch_addr++) {
+        if (!(trace.ch_mask & (1U << ch_addr))) {
+          continue;
+        }
         Addr_t addr = 0;
         
         // RoBaRaCoCh: Row -> Bank -> Rank -> Column -> Channel
@@ -201,12 +139,11 @@ class RoBaRaCoCh final : public LinearMapperBase, public Implementation {
         addr <<= m_addr_bits[m_col_bits_idx];
         addr |= trace.col_addr;
         addr <<= m_addr_bits[0];  // Channel bits
-        addr |= ch_addrs[i];
+        addr |= ch_addr;
         addr <<= m_tx_offset;
 
-        addrs[i] = addr;
+        addrs.push_back(addr);
       }
-      return addrs;
     }
 
     IDRAM* get_m_dram() override {
@@ -241,32 +178,41 @@ class MOP4CLXOR final : public LinearMapperBase, public Implementation {
           row_xor_index += m_addr_bits[lvl];
         }
       }
+      if (req.is_inter_bg) {
+        set_inter_bg_bank_addrs(req);
+      }
     }
 
-    std::vector<Addr_t> convert_pkt_addr(const Trace& trace) override {
+    void convert_pkt_addr(const Trace& trace, std::vector<Addr_t>& addrs) override {
+      if (trace.is_inter_bg) {
+        throw ConfigurationError("MOP4CLXOR: inter-bankgroup AiM bank masks are not supported!");
+      }
+
       // For MOP4CLXOR mapping, implement XOR-based address conversion
-      std::vector<int> ch_addrs = convert_mask_to_id(trace.ch_mask, 0);
-      std::vector<Addr_t> addrs(ch_addrs.size(), 0);
+      addrs.clear();
 
       // TODO: Implement MOP4CLXOR-specific address conversion logic
       // This is a placeholder implementation - you may need to adjust
       // based on your specific MOP4CLXOR mapping requirements
       
-      for (size_t i = 0; i < ch_addrs.size(); i++) {
+      int num_chs = 1U << m_addr_bits[m_ch_idx];
+      for (int ch_addr = 0; ch_addr < num_chs; ch_addr++) {
+        if (!(trace.ch_mask & (1U << ch_addr))) {
+          continue;
+        }
         Addr_t addr = 0;
         
         // Apply XOR-based mapping similar to the apply() method
         // Build basic address first
-        addr = ch_addrs[i];
+        addr = ch_addr;
         addr <<= m_addr_bits[m_row_bits_idx];
         addr |= trace.row_addr;
         addr <<= m_addr_bits[m_col_bits_idx];
         addr |= trace.col_addr;
         addr <<= m_tx_offset;
 
-        addrs[i] = addr;
+        addrs.push_back(addr);
       }
-      return addrs;
     }
 
     IDRAM* get_m_dram() override {
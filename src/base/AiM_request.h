@@ -2,19 +2,55 @@
 #define     RAMULATOR_AIM_REQUEST_H
 
 #include <vector>
+#include <cassert>
 #include <list>
+#include <memory>
+#include <iterator>
 #include <string>
 
 #include "base/base.h"
 
 namespace Ramulator {
 
-struct Request { 
-  Addr_t    addr = -1;
-  AddrHierarchy_t addr_h {};
+struct Request;
 
-  bool is_aim_req = false;
+/**
+ * @brief     A move-only handle to the callback invoked when a request is served.
+ * @details
+ * The std::function is held by value rather than behind a pointer of its own, so only std::function
+ * itself may allocate (e.g., for large captures). Only Request can copy the handle, through Request::clone().
+ * 
+ */
+class RequestCallback {
+  public:
+    using Callback_t = std::function<void(Request&)>;
+
+    RequestCallback() = default;
+    RequestCallback(std::nullptr_t) {};
+    RequestCallback(Callback_t callback) : m_callback(std::move(callback)) {};
+    RequestCallback(RequestCallback&& other) noexcept = default;
+    RequestCallback& operator=(const RequestCallback& other) = delete;
+    RequestCallback& operator=(RequestCallback&& other) noexcept = default;
+    RequestCallback& operator=(std::nullptr_t) { m_callback = nullptr; return *this; };
+
+    explicit operator bool() const { return static_cast<bool>(m_callback); };
+    void operator()(Request& req) const { m_callback(req); };
+
+  private:
+    friend struct Request;
+    RequestCallback(const RequestCallback& other) = default;
 
+    Callback_t m_callback;
+};
+
+/**
+ * @brief     A memory request.
+ * @details
+ * Requests are move-only: they are moved from the frontend through the memory system into the
+ * controller buffers and pending queues. Use clone() where an actual copy is needed.
+ * 
+ */
+struct Request { 
   // Basic request id convention
   // 0 = Read, 1 = Write. The device spec defines all others
   struct Type {
@@ -27,16 +63,33 @@ struct Request {
       MAC_ABK = 10, AF_ABK = 11, WR_AFLUT = 12, WR_BK = 13,
       // AiM No Bank
       WR_GB = 14, WR_MAC = 15, WR_BIAS = 16, RD_MAC = 17, RD_AF = 18,
+      // AiM Multi-Bank (one bank in each bankgroup)
+      MAC_4BK_INTER_BG = 19, AF_4BK_INTER_BG = 20,
       // End of Type
-      UNKNOWN = 19,
-      // TODO
-      // MAC_4BK_INTER_BG = 8, AF_4BK_INTER_BG = 9,
+      UNKNOWN = 21,
     };
   };
 
-  int aim_num_banks = -1;
-  bool is_inter_bg = false;
-  uint16_t inter_bg_bank_addrs;
+  // Members are ordered by size to keep the request compact
+
+  Addr_t    addr = -1;
+
+  // Clock cycle when the request is accepted by the memory system (before any staging)
+  Clk_t accept = -1;
+  // Clock cycle when the request arrive at the memory controller
+  Clk_t arrive = -1;
+  // Clock cycle when the request depart the memory controller
+  Clk_t depart = -1;
+  // Clock cycle when the request issued at the memory controller
+  Clk_t issue = -1;
+
+  // Scheduler caches of the prerequisite command and the cycle it becomes ready at,
+  // valid as long as the state/timing versions of the channel (see IDRAM) do not change
+  int64_t preq_version = -1;
+  int64_t ready_version = -1;
+  Clk_t ready_clk = -1;
+
+  AddrHierarchy_t addr_h {};
 
   // An identifier for the type of the request
   int type_id = Request::Type::UNKNOWN;
@@ -47,24 +100,31 @@ struct Request {
   int command = -1;
   // The final command that is needed to finish the request
   int final_command = -1;
-  // Memory controller stats
-  bool is_stat_updated = false;
 
-  // Clock cycle when the request arrive at the memory controller
-  Clk_t arrive = -1;
-  // Clock cycle when the request depart the memory controller
-  Clk_t depart = -1;
-  // Clock cycle when the request issued at the memory controller
-  Clk_t issue = -1;
+  int aim_num_banks = -1;
+  // The banks an inter-bankgroup request operates on, one bit per bank (bankgroup-major); set by the address mapper
+  uint16_t inter_bg_bank_addrs = 0;
 
-  // A scratchpad for the request
-  std::array<int, 4> scratchpad = { 0 };
+  bool is_aim_req = false;
+  // Inter-bankgroup 4-bank requests operate on the same bank of every bankgroup
+  bool is_inter_bg = false;
+  // Memory controller stats
+  bool is_stat_updated = false;
+  // Set by schedulers that issue the row commands of the request ahead of its turn (e.g., RowPrefetch), and cleared once its turn comes.
+  // Such a request stays in its buffer instead of moving to the active buffer, so its accesses keep their order.
+  bool is_row_prefetched = false;
 
-  std::function<void(Request&)> callback;
+  RequestCallback callback;
 
   // Point to a generic payload
   void* m_payload = nullptr;
 
+  Request(Request&& other) noexcept = default;
+  Request& operator=(Request&& other) noexcept = default;
+  Request& operator=(const Request& other) = delete;
+
+  Request clone() const { return Request(*this); };
+
   Request(Addr_t addr, int type_id);
   Request(AddrHierarchy_t addr_h, int type_id);
   Request(Addr_t addr, int type_id, int source_id, std::function<void(Request&)> callback);
@@ -76,6 +136,14 @@ struct Request {
   Request(bool is_aim_req, int type_id, int aim_num_banks, std::function<void(Request&)> tmp_callback);
   // New Wrapper
   Request(bool is_aim_req, int req_type_id, Addr_t addr, int aim_num_banks, std::function<void(Request&)> callback);
+
+  static bool is_inter_bg_type(int type_id) {
+    return type_id == Type::MAC_4BK_INTER_BG || type_id == Type::AF_4BK_INTER_BG;
+  };
+
+  private:
+    // Only used by clone(); RequestCallback lets Request copy the callback
+    Request(const Request& other) = default;
 };
 
 inline std::string str_type_name(int type_id) {
@@ -99,25 +167,95 @@ inline std::string str_type_name(int type_id) {
     case Request::Type::WR_BIAS: return "WR_BIAS";
     case Request::Type::RD_MAC: return "RD_MAC";
     case Request::Type::RD_AF: return "RD_AF";
+    case Request::Type::MAC_4BK_INTER_BG: return "MAC_4BK_INTER_BG";
+    case Request::Type::AF_4BK_INTER_BG: return "AF_4BK_INTER_BG";
     default: return "UNKNOWN";
-    // case Request::Type::MAC_4BK_INTER_BG: return "MAC_4BK_INTER_BG";
-    // case Request::Type::AF_4BK_INTER_BG: return "AF_4BK_INTER_BG";
   }
 };
 
+/**
+ * @brief     A FIFO request buffer that supports removal from the middle.
+ * @details
+ * Requests live in a fixed-capacity slot array (max_size slots, reserved by the first enqueue()) and are
+ * linked in arrival order through slot indices. Removed slots are recycled through a free list (keeping
+ * the storage of their requests), so enqueue() and remove() never reallocate the array. Iterators refer
+ * to slots by index and stay valid until the request they point to is removed.
+ * 
+ */
 struct ReqBuffer {
-  std::list<Request> buffer;
+  struct Slot {
+    Request req;
+    int prev = -1;
+    int next = -1;
+  };
+
+  std::vector<Slot> slots;
+  int head = -1;
+  int tail = -1;
+  int free_head = -1;   // Free slots are chained through Slot::next
+  size_t count = 0;
   size_t max_size = 16384;
 
-  using iterator = std::list<Request>::iterator;
-  iterator begin() { return buffer.begin(); };
-  iterator end() { return buffer.end(); };
+  class iterator {
+    public:
+      using iterator_category = std::forward_iterator_tag;
+      using value_type = Request;
+      using difference_type = std::ptrdiff_t;
+      using pointer = Request*;
+      using reference = Request&;
+
+      iterator() = default;
+      iterator(ReqBuffer* buffer, int idx) : m_buffer(buffer), m_idx(idx) {};
+
+      reference operator*() const { return m_buffer->slots[m_idx].req; };
+      pointer operator->() const { return &m_buffer->slots[m_idx].req; };
+      iterator& operator++() { m_idx = m_buffer->slots[m_idx].next; return *this; };
+      iterator operator++(int) { iterator it = *this; ++(*this); return it; };
+      bool operator==(const iterator& other) const { return m_idx == other.m_idx && m_buffer == other.m_buffer; };
+      bool operator!=(const iterator& other) const { return !(*this == other); };
+
+    private:
+      friend struct ReqBuffer;
+      ReqBuffer* m_buffer = nullptr;
+      int m_idx = -1;
+  };
 
-  size_t size() const { return buffer.size(); }
+  iterator begin() { return iterator(this, head); };
+  iterator end() { return iterator(this, -1); };
 
-  bool enqueue(const Request& request) {
-    if (buffer.size() <= max_size) {
-      buffer.push_back(request);
+  size_t size() const { return count; }
+
+  // The request enqueued last
+  Request& back() { return slots[tail].req; };
+
+  /**
+   * @brief     Moves the request into the buffer. The request is left untouched if the buffer is full.
+   * 
+   */
+  bool enqueue(Request&& request) {
+    if (count < max_size) {
+      if (slots.capacity() == 0) {
+        // max_size may be set after construction, so the slots are reserved here
+        slots.reserve(max_size);
+      }
+      int idx = free_head;
+      if (idx != -1) {
+        free_head = slots[idx].next;
+        slots[idx].req = std::move(request);
+      } else {
+        assert(slots.size() < max_size && "ReqBuffer: the slot array exceeds its capacity!");
+        idx = slots.size();
+        slots.push_back({std::move(request)});
+      }
+      slots[idx].prev = tail;
+      slots[idx].next = -1;
+      if (tail != -1) {
+        slots[tail].next = idx;
+      } else {
+        head = idx;
+      }
+      tail = idx;
+      count++;
       return true;
     } else {
       return false;
@@ -125,7 +263,22 @@ struct ReqBuffer {
   }
 
   void remove(iterator it) {
-    buffer.erase(it);
+    Slot& slot = slots[it.m_idx];
+    if (slot.prev != -1) {
+      slots[slot.prev].next = slot.next;
+    } else {
+      head = slot.next;
+    }
+    if (slot.next != -1) {
+      slots[slot.next].prev = slot.prev;
+    } else {
+      tail = slot.prev;
+    }
+    // Do not keep whatever the callback captured alive
+    slot.req.callback = nullptr;
+    slot.next = free_head;
+    free_head = it.m_idx;
+    count--;
   }
 };
 
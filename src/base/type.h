@@ -1,7 +1,11 @@
 #ifndef     RAMULATOR_BASE_TYPE_H
 #define     RAMULATOR_BASE_TYPE_H
 
+#include <array>
 #include <vector>
+#include <cstdint>
+#include <stdexcept>
+#include <initializer_list>
 #include <unordered_map>
 #include <string>
 #include <type_traits>
@@ -11,8 +15,81 @@ namespace Ramulator {
   using Clk_t     = int64_t;
   // Plain address as seen by the OS
   using Addr_t    = int64_t;
-  // Device address vector as is sent to the device from the controller
-  using AddrHierarchy_t = std::vector<int>;
+
+  /**
+   * @brief     Device address vector as is sent to the device from the controller.
+   * @details
+   * A vector-like container with its storage inline, so that requests carrying an address hierarchy
+   * can be created, moved, and copied without touching the heap. Holds at most MAX_LEVELS levels.
+   * 
+   */
+  class AddrHierarchy {
+    public:
+      static constexpr size_t MAX_LEVELS = 8;
+
+      using value_type = int;
+      using size_type = size_t;
+      using iterator = int*;
+      using const_iterator = const int*;
+
+      AddrHierarchy() = default;
+      AddrHierarchy(size_t size, int val) { resize(size, val); };
+      AddrHierarchy(std::initializer_list<int> addrs) {
+        check_size(addrs.size());
+        for (int addr : addrs) {
+          m_addrs[m_size++] = addr;
+        }
+      };
+
+      size_t size() const { return m_size; };
+      bool empty() const { return m_size == 0; };
+
+      void resize(size_t size, int val = 0) {
+        check_size(size);
+        for (size_t i = m_size; i < size; i++) {
+          m_addrs[i] = val;
+        }
+        m_size = size;
+      };
+      void push_back(int addr) {
+        check_size(m_size + 1);
+        m_addrs[m_size++] = addr;
+      };
+
+      int& operator[](size_t i) { return m_addrs[i]; };
+      const int& operator[](size_t i) const { return m_addrs[i]; };
+
+      int* data() { return m_addrs.data(); };
+      const int* data() const { return m_addrs.data(); };
+      iterator begin() { return m_addrs.data(); };
+      iterator end() { return m_addrs.data() + m_size; };
+      const_iterator begin() const { return m_addrs.data(); };
+      const_iterator end() const { return m_addrs.data() + m_size; };
+
+      bool operator==(const AddrHierarchy& other) const {
+        if (m_size != other.m_size) {
+          return false;
+        }
+        for (size_t i = 0; i < m_size; i++) {
+          if (m_addrs[i] != other.m_addrs[i]) {
+            return false;
+          }
+        }
+        return true;
+      };
+      bool operator!=(const AddrHierarchy& other) const { return !(*this == other); };
+
+    private:
+      static void check_size(size_t size) {
+        if (size > MAX_LEVELS) {
+          throw std::length_error("Address hierarchy deeper than AddrHierarchy::MAX_LEVELS!");
+        }
+      };
+
+      std::array<int, MAX_LEVELS> m_addrs {};
+      uint32_t m_size = 0;
+  };
+  using AddrHierarchy_t = AddrHierarchy;
 
   template<typename T>
   using Registry_t = std::unordered_map<std::string, T>;
@@ -5,6 +5,7 @@
 #include <vector>
 #include <map>
 #include <functional>
+#include <limits>
 
 #include "base/base.h"
 #include "dram/spec.h"
@@ -39,8 +40,7 @@ class IDRAM : public Clocked<IDRAM> {
     SpecLUT<Command_t> m_aim_req_translation{m_aim_req};
     SpecLUT<Level_t> m_command_action_scope{m_commands};
 
-    // TODO: make this a priority queue
-    std::vector<FutureAction> m_future_actions;  // A vector of requests that requires future state changes
+    std::vector<FutureActionQueue> m_future_actions;  // Per channel, the commands whose state changes take effect in the future
 
   /************************************************
    *                Node States
@@ -127,6 +127,66 @@ class IDRAM : public Clocked<IDRAM> {
      */
     virtual bool check_node_open(int command, const AddrHierarchy_t& addr_h) = 0;
 
+    /**
+     * @brief     Returns the earliest cycle at which the readiness of a command to the channel can change.
+     * @details
+     * Used by event-driven fast-forwarding. Until the returned cycle, check_ready() and get_preq_command()
+     * keep returning the same results for the channel as long as no new command is issued to it.
+     * The default is conservative (i.e., the next cycle).
+     * 
+     */
+    virtual Clk_t get_next_ready_clk(int channel_id) { return m_clk + 1; };
+
+    /**
+     * @brief     Returns the earliest cycle at which check_ready() holds for the given command and address.
+     * @details
+     * The result stays valid as long as get_timing_version() of the channel does not change.
+     * The default is conservative (i.e., the command is only known to be ready or not in the current cycle).
+     * 
+     */
+    virtual Clk_t get_ready_clk(int command, const AddrHierarchy_t& addr_h) {
+      return check_ready(command, addr_h) ? m_clk : m_clk + 1;
+    };
+
+    /**
+     * @brief     Returns the version of the node states of the channel.
+     * @details
+     * The version changes whenever get_preq_command() may return a different command for an address in the channel,
+     * so that the scheduler can keep the prerequisite commands of its requests until then.
+     * The default changes every cycle.
+     * 
+     */
+    virtual int64_t get_state_version(int channel_id) { return m_clk; };
+
+    /**
+     * @brief     Returns the version of the timing information of the channel.
+     * @details
+     * The version changes whenever get_ready_clk() may return a different cycle for an address in the channel.
+     * The default changes every cycle.
+     * 
+     */
+    virtual int64_t get_timing_version(int channel_id) { return m_clk; };
+
+    Clk_t get_clk() const { return m_clk; };
+
+    /**
+     * @brief     Returns the cycle at which the earliest pending future action is executed.
+     * 
+     */
+    Clk_t get_next_event_clk() {
+      Clk_t next_event_clk = std::numeric_limits<Clk_t>::max();
+      for (const auto& channel_future_actions : m_future_actions) {
+        next_event_clk = std::min(next_event_clk, channel_future_actions.next_clk());
+      }
+      return next_event_clk;
+    };
+
+    /**
+     * @brief     Advances the clock over cycles in which nothing happens in the device.
+     * 
+     */
+    virtual void fast_forward(Clk_t num_cycles) { m_clk += num_cycles; };
+
     /**
      * @brief     An universal interface for the host to change DRAM configurations on the fly
      * @details
@@ -6,6 +6,9 @@
 #include <deque>
 #include <functional>
 #include <concepts>
+#include <limits>
+#include <algorithm>
+#include <new>
 
 #include "base/type.h"
 #include "dram/spec.h"
@@ -28,6 +31,222 @@ concept IsDRAMSpec = requires(T t) {
 // };
 
 
+/**
+ * @brief     An allocator of cache-line-aligned arrays
+ * @details
+ * An array padded to a whole number of cache lines (see padded_size()) never shares a cache line with other data.
+ * 
+ */
+template<typename T>
+struct CacheLineAllocator {
+  using value_type = T;
+  static constexpr size_t CACHE_LINE_SIZE = 64;
+
+  CacheLineAllocator() = default;
+  template<typename U>
+  CacheLineAllocator(const CacheLineAllocator<U>&) {};
+
+  T* allocate(size_t n) {
+    return static_cast<T*>(::operator new(n * sizeof(T), std::align_val_t(CACHE_LINE_SIZE)));
+  };
+  void deallocate(T* p, size_t) {
+    ::operator delete(p, std::align_val_t(CACHE_LINE_SIZE));
+  };
+  template<typename U>
+  bool operator==(const CacheLineAllocator<U>&) const { return true; };
+
+  // Rounds the number of elements up to a whole number of cache lines
+  static size_t padded_size(size_t n) {
+    constexpr size_t num_per_line = CACHE_LINE_SIZE / sizeof(T);
+    return (n + num_per_line - 1) / num_per_line * num_per_line;
+  };
+};
+
+/**
+ * @brief     Timing information of all nodes of a device, stored in flat per-channel blocks
+ * @details
+ * The nodes of each level of a channel are numbered breadth-first (flat id), so that the children of a node
+ * occupy a contiguous range of flat ids at the next level. Each channel has its own block, laid out as
+ * [level][cmd][flat id] for the ready clocks (the ready clocks of one command for all nodes of a level are
+ * contiguous), and the issue-histories of each (level, command) pair with a fixed window per node. Each window
+ * is a ring buffer, so recording an issue writes a single entry.
+ *
+ * Ready clocks only ever increase, so each node also keeps the latest ready clock of every command
+ * among all of its descendants. Multi-bank commands read it at their action scope instead of
+ * visiting every bank of the subtree.
+ *
+ * The blocks are padded to whole cache lines, so the controllers of different channels ticked by different
+ * threads (i.e., AiMSystem's num_threads > 1) never write to the same cache line.
+ * 
+ */
+struct DRAMFlatTiming {
+  int m_num_channels = 0;
+  // Number of nodes of a channel at each level (1 at the channel level)
+  std::vector<int> m_num_nodes;
+  // Number of children of a node at each level (0 for the leaf level)
+  std::vector<int> m_num_children;
+
+  // [channel * m_block_size + offset within the block]
+  std::vector<Clk_t, CacheLineAllocator<Clk_t>> m_clks;
+  size_t m_block_size = 0;
+  // [level], the offsets of [cmd * m_num_nodes[level] + flat_id]
+  std::vector<size_t> m_ready_offset;
+  // [level], the offsets of [cmd * m_num_nodes[level] + flat_id], the maximum ready clock among all descendants of the node
+  std::vector<size_t> m_subtree_ready_offset;
+  // [level][cmd], the offsets of [flat_id * m_history_window[level][cmd] + i]
+  std::vector<std::vector<int>> m_history_window;
+  std::vector<std::vector<size_t>> m_history_offset;
+
+  // [channel * m_head_block_size + m_head_offset[level] + cmd * m_num_nodes[level] + flat_id], the position of the latest entry in the window
+  std::vector<int, CacheLineAllocator<int>> m_history_heads;
+  size_t m_head_block_size = 0;
+  std::vector<size_t> m_head_offset;
+
+  /**
+   * @brief    Sizes the arrays after the organization and timing constraints of the spec. Must be called before creating the nodes.
+   * 
+   */
+  template<typename T>
+  void init(T* spec) {
+    int num_cmds = T::m_commands.size();
+    int last_level = T::m_levels["row"];
+    const auto& count = spec->m_organization.count;
+
+    // The node tree stops at the row level or at the first level without nodes
+    int num_node_levels = 1;
+    while (num_node_levels < last_level && count[num_node_levels] != 0) {
+      num_node_levels++;
+    }
+
+    m_num_channels = count[0];
+    m_num_nodes.resize(num_node_levels);
+    m_num_children.resize(num_node_levels);
+    m_ready_offset.resize(num_node_levels);
+    m_subtree_ready_offset.resize(num_node_levels);
+    m_history_window.resize(num_node_levels, std::vector<int>(num_cmds, 0));
+    m_history_offset.resize(num_node_levels, std::vector<size_t>(num_cmds, 0));
+    m_head_offset.resize(num_node_levels);
+
+    size_t block_size = 0;
+    size_t head_block_size = 0;
+    for (int level = 0; level < num_node_levels; level++) {
+      m_num_nodes[level] = (level == 0) ? 1 : m_num_nodes[level - 1] * count[level];
+      m_num_children[level] = (level + 1 < num_node_levels) ? count[level + 1] : 0;
+
+      m_ready_offset[level] = block_size;
+      block_size += (size_t) num_cmds * m_num_nodes[level];
+      m_subtree_ready_offset[level] = block_size;
+      block_size += (size_t) num_cmds * m_num_nodes[level];
+      for (int cmd = 0; cmd < num_cmds; cmd++) {
+        int window = 0;
+        for (const auto& t : spec->m_timing_cons[level][cmd]) {
+          window = std::max(window, t.window);
+        }
+        m_history_window[level][cmd] = window;
+        m_history_offset[level][cmd] = block_size;
+        block_size += (size_t) window * m_num_nodes[level];
+      }
+
+      m_head_offset[level] = head_block_size;
+      head_block_size += (size_t) num_cmds * m_num_nodes[level];
+    }
+
+    m_block_size = CacheLineAllocator<Clk_t>::padded_size(block_size);
+    m_clks.assign(m_num_channels * m_block_size, -1);
+    m_head_block_size = CacheLineAllocator<int>::padded_size(head_block_size);
+    m_history_heads.assign(m_num_channels * m_head_block_size, 0);
+  };
+
+  Clk_t& ready_clk(int level, int cmd, int channel_id, int flat_id) {
+    return m_clks[channel_id * m_block_size + m_ready_offset[level] + (size_t) cmd * m_num_nodes[level] + flat_id];
+  };
+
+  Clk_t subtree_ready_clk(int level, int cmd, int channel_id, int flat_id) const {
+    return m_clks[channel_id * m_block_size + m_subtree_ready_offset[level] + (size_t) cmd * m_num_nodes[level] + flat_id];
+  };
+
+  /**
+   * @brief    Delays the ready clock of the command at the node to (at least) clk, and propagates it to the ancestors' subtree ready clocks.
+   * 
+   */
+  void raise_ready_clk(int level, int cmd, int channel_id, int flat_id, Clk_t clk) {
+    Clk_t& ready = ready_clk(level, cmd, channel_id, flat_id);
+    if (clk <= ready) {
+      return;
+    }
+    ready = clk;
+    // Stop at the first ancestor whose subtree is already as late (so are all of its ancestors)
+    Clk_t* block = &m_clks[channel_id * m_block_size];
+    while (level > 0) {
+      level--;
+      flat_id /= m_num_children[level];
+      Clk_t& subtree_ready = block[m_subtree_ready_offset[level] + (size_t) cmd * m_num_nodes[level] + flat_id];
+      if (clk <= subtree_ready) {
+        return;
+      }
+      subtree_ready = clk;
+    }
+  };
+
+  /**
+   * @brief    Records an issue of the command at the node, dropping the oldest entry of its window.
+   * 
+   */
+  void push_history(int level, int cmd, int channel_id, int flat_id, Clk_t clk) {
+    const int window = m_history_window[level][cmd];
+    if (!window) {
+      return;
+    }
+    int& head = history_head(level, cmd, channel_id, flat_id);
+    head = (head == 0) ? window - 1 : head - 1;
+    m_clks[channel_id * m_block_size + m_history_offset[level][cmd] + (size_t) flat_id * window + head] = clk;
+  };
+
+  /**
+   * @brief    Returns the i-th latest issue of the command at the node (-1 if there is not enough history), i < window.
+   * 
+   */
+  Clk_t history(int level, int cmd, int channel_id, int flat_id, int i) {
+    const int window = m_history_window[level][cmd];
+    int pos = history_head(level, cmd, channel_id, flat_id) + i;
+    if (pos >= window) {
+      pos -= window;
+    }
+    return m_clks[channel_id * m_block_size + m_history_offset[level][cmd] + (size_t) flat_id * window + pos];
+  };
+
+  private:
+    int& history_head(int level, int cmd, int channel_id, int flat_id) {
+      return m_history_heads[channel_id * m_head_block_size + m_head_offset[level] + (size_t) cmd * m_num_nodes[level] + flat_id];
+    };
+};
+
+/**
+ * @brief     The open row of every bank-ish (i.e., leaf) node of a device, stored densely by flat id
+ * @details
+ * An AiM bank has at most one open (or pre-opened) row, so a single row id per bank replaces a
+ * per-bank map of row states. Like DRAMFlatTiming, each channel has its own block padded to whole cache lines.
+ * 
+ */
+struct DRAMOpenRows {
+  static constexpr int NO_OPEN_ROW = -1;
+  std::vector<int, CacheLineAllocator<int>> m_open_row;
+  size_t m_block_size = 0;
+
+  /**
+   * @brief    Sizes the array after the node tree of the device. Must be called after DRAMFlatTiming::init().
+   * 
+   */
+  void init(const DRAMFlatTiming& timing) {
+    m_block_size = CacheLineAllocator<int>::padded_size(timing.m_num_nodes.back());
+    m_open_row.assign(timing.m_num_channels * m_block_size, NO_OPEN_ROW);
+  };
+
+  int& open_row(int channel_id, int flat_id) {
+    return m_open_row[channel_id * m_block_size + flat_id];
+  };
+};
+
 /**
  * @brief     CRTP-ish (?) base class of a DRAM Device Node
  * 
@@ -44,33 +263,25 @@ struct DRAMNodeBase {
   int m_level = -1;
   // The id of this node at this level
   int m_node_id = -1;
+  // The channel of this node
+  int m_channel_id = -1;
+  // The id of this node among the nodes of its channel at this level (i.e., its index into the spec's DRAMFlatTiming)
+  int m_flat_id = -1;
   // The size of the node (e.g., how many rows in a bank)
   int m_size = -1;
   // The state of the node
   int m_state = -1;
-  // The next cycle that each command can be issued again at this level
-  std::vector<Clk_t> m_cmd_ready_clk;
-  // Issue-history of each command at this level
-  std::vector<std::deque<Clk_t>> m_cmd_history;
+  // The next cycle that each command can be issued again and the issue-history of each command
+  // at this level live in m_spec->m_flat_timing
 
   using RowId_t = int;
-  using RowState_t = int;
-  // The state of the rows, if I am a bank-ish node
-  std::map<RowId_t, RowState_t> m_row_state;
+  // The open row, if I am a bank-ish node, lives in m_spec->m_open_row_ids (whether it is opened or
+  // pre-opened is given by m_state)
 
   DRAMNodeBase(T* spec, NodeType* parent, int level, int id):
   m_spec(spec), m_parent_node(parent), m_level(level), m_node_id(id) {
-    int num_cmds = T::m_commands.size();
-    m_cmd_ready_clk.resize(num_cmds, -1);
-    m_cmd_history.resize(num_cmds);
-    for (int cmd = 0; cmd < num_cmds; cmd++) {
-      int window = 0;
-      for (const auto& t : spec->m_timing_cons[level][cmd]) {
-        window = std::max(window, t.window);
-      }
-      if (window != 0) { m_cmd_history[cmd].resize(window, -1); }
-      else { m_cmd_history[cmd].clear(); }
-    }
+    m_channel_id = parent ? parent->m_channel_id : id;
+    m_flat_id = parent ? parent->m_flat_id * m_spec->m_organization.count[level] + id : 0;
 
     m_state = spec->m_init_states[m_level];
 
@@ -90,11 +301,19 @@ struct DRAMNodeBase {
     }
   };
 
-  void update_states(int command, const AddrHierarchy_t& addr_h, Clk_t clk) {
+  RowId_t get_open_row() const { return m_spec->m_open_row_ids.open_row(m_channel_id, m_flat_id); };
+  bool is_row_open(RowId_t row_id) const { return row_id != DRAMOpenRows::NO_OPEN_ROW && get_open_row() == row_id; };
+  void set_open_row(RowId_t row_id) { m_spec->m_open_row_ids.open_row(m_channel_id, m_flat_id) = row_id; };
+  void clear_open_row() { m_spec->m_open_row_ids.open_row(m_channel_id, m_flat_id) = DRAMOpenRows::NO_OPEN_ROW; };
+
+  // Returns whether an action lambda was executed (i.e., whether any state may have changed)
+  bool update_states(int command, const AddrHierarchy_t& addr_h, Clk_t clk) {
+    bool is_updated = false;
     // 1. Execute the action lambda if one is defined for the current node level.
     if (m_spec->m_actions[m_level][command]) {
       // update the state machine at this level
       m_spec->m_actions[m_level][command](static_cast<NodeType*>(this), command, addr_h, clk); 
+      is_updated = true;
     }
 
     // 2. Determine if we should STOP the recursion.
@@ -108,7 +327,7 @@ struct DRAMNodeBase {
     if ((action_scope != -1 && m_level == action_scope) ||
         (m_level == m_spec->m_command_addressing_level[command]) ||
         !m_child_nodes.size()) {
-      return;
+      return is_updated;
     }
 
     // 3. RECURSE to the next level on the single path.
@@ -116,9 +335,9 @@ struct DRAMNodeBase {
     //    down a single path (like a standard ACT needing to update a row's state),
     //    and only when we are above the command's final addressing level.
     int child_id = addr_h[m_level + 1];
-    if (child_id < 0) { return; }
+    if (child_id < 0) { return is_updated; }
 
-    m_child_nodes[child_id]->update_states(command, addr_h, clk);
+    return m_child_nodes[child_id]->update_states(command, addr_h, clk) || is_updated;
   };
 
   void update_powers(int command, const AddrHierarchy_t& addr_h, Clk_t clk) {
@@ -157,7 +376,7 @@ struct DRAMNodeBase {
 
         // update earliest schedulable time of every command
         Clk_t future = clk + t.val;
-        m_cmd_ready_clk[t.cmd] = std::max(m_cmd_ready_clk[t.cmd], future);
+        m_spec->m_flat_timing.raise_ready_clk(m_level, t.cmd, m_channel_id, m_flat_id, future);
       }
       // stop recursion
       return;
@@ -167,10 +386,7 @@ struct DRAMNodeBase {
      *          Update Target Node Timing
      ***********************************************/
     // Update history
-    if (m_cmd_history[command].size()) {
-      m_cmd_history[command].pop_back();
-      m_cmd_history[command].push_front(clk); 
-    }
+    m_spec->m_flat_timing.push_history(m_level, command, m_channel_id, m_flat_id, clk);
 
     for (const auto& t : m_spec->m_timing_cons[m_level][command]) {
       if (t.sibling) {
@@ -178,7 +394,7 @@ struct DRAMNodeBase {
       }
 
       // Get the oldest history
-      Clk_t past = m_cmd_history[command][t.window-1];
+      Clk_t past = m_spec->m_flat_timing.history(m_level, command, m_channel_id, m_flat_id, t.window - 1);
       if (past < 0) {
         // not enough history
         continue; 
@@ -186,7 +402,7 @@ struct DRAMNodeBase {
 
       // update earliest schedulable time of every command
       Clk_t future = past + t.val;
-      m_cmd_ready_clk[t.cmd] = std::max(m_cmd_ready_clk[t.cmd], future);
+      m_spec->m_flat_timing.raise_ready_clk(m_level, t.cmd, m_channel_id, m_flat_id, future);
     }
 
     /************************************************
@@ -200,7 +416,15 @@ struct DRAMNodeBase {
 
     const int action_scope = m_spec->m_command_action_scope[command];
 
-    if (action_scope != -1 && m_level >= action_scope) {
+    if (m_level == action_scope && m_spec->m_command_meta[command].is_sb_cmd) {
+      // SAME-BANK FAN-OUT RECURSION:
+      // Every child of the action scope is a target, below which the single path of the address is followed
+      AddrHierarchy_t child_addr_h = addr_h;
+      for (auto child : m_child_nodes) {
+        child_addr_h[m_level + 1] = child->m_node_id;
+        child->update_timing(command, child_addr_h, clk);
+      }
+    } else if (action_scope != -1 && m_level >= action_scope && !m_spec->m_command_meta[command].is_sb_cmd) {
       // FAN-OUT RECURSION:
       for (auto child : m_child_nodes) {
         child->update_timing(command, addr_h, clk);
@@ -252,43 +476,78 @@ struct DRAMNodeBase {
   };
 
   bool check_ready(int command, const AddrHierarchy_t& addr_h, Clk_t clk) {
-    // 1. Check local timing constraints at the current level.
-    if (m_cmd_ready_clk[command] != -1 && clk < m_cmd_ready_clk[command]) {
-      // A timing constraint at this level prevents the command.
-      // stop recursion: the check failed at this level
-      return false;
+    return get_ready_clk(command, addr_h) <= clk;
+  };
+
+  /**
+   * @brief    Returns the earliest cycle at which all timing constraints on the command are met in this subtree
+   * @details
+   * Follows the single path of the address down to the command's action scope. A multi-bank command
+   * must wait for every node below its action scope, which is the aggregated subtree ready clock of
+   * the node at the action scope (i.e., no per-bank traversal). A same-bank command (e.g., the
+   * inter-bankgroup 4-bank commands) only waits for the single path of the address below each child
+   * of its action scope.
+   */
+  Clk_t get_ready_clk(int command, const AddrHierarchy_t& addr_h) {
+    DRAMFlatTiming& timing = m_spec->m_flat_timing;
+    const int action_scope = m_spec->m_command_action_scope[command];
+
+    int level = m_level;
+    int flat_id = m_flat_id;
+    Clk_t ready_clk = timing.ready_clk(level, command, m_channel_id, flat_id);
+    // 1. Single path down to the action scope.
+    if (!descend(command, addr_h, action_scope, level, flat_id, ready_clk)) {
+      return std::numeric_limits<Clk_t>::max();
+    }
+    if (level != action_scope || is_path_end(command, level)) {
+      return ready_clk;
     }
 
-    // 2. Stop condition: Check passed at all levels.
-    if (m_level == m_spec->m_command_addressing_level[command] || !m_child_nodes.size()) {
-      return true;
+    // 2. All nodes below the action scope.
+    if (!m_spec->m_command_meta[command].is_sb_cmd) {
+      return std::max(ready_clk, timing.subtree_ready_clk(level, command, m_channel_id, flat_id));
     }
 
-    // 3. Determine the recursion policy (Single-Path vs. Fan-Out).
-    // Check if the current command has a defined multi-node action scope.
-    // The LUT will return a special value (e.g., -1) if the command is not a group command.
-    const int action_scope = m_spec->m_command_action_scope[command];
+    // 2'. Single path below each child of the action scope.
+    const int num_children = timing.m_num_children[level];
+    for (int child_id = 0; child_id < num_children; child_id++) {
+      int child_level = level + 1;
+      int child_flat_id = flat_id * num_children + child_id;
+      ready_clk = std::max(ready_clk, timing.ready_clk(child_level, command, m_channel_id, child_flat_id));
+      if (!descend(command, addr_h, -1, child_level, child_flat_id, ready_clk)) {
+        return std::numeric_limits<Clk_t>::max();
+      }
+    }
+    return ready_clk;
+  };
 
-    if (m_level == action_scope) {
-      // FAN-OUT RECURSION:
-      bool all_children_ready = true;
-      for (auto child : m_child_nodes) {
-        if (!child->check_ready(command, addr_h, clk)) {
-          all_children_ready = false;
-          break;
+  /**
+   * @brief    Returns the earliest cycle after clk at which a timing constraint in this subtree expires
+   * @details
+   * Between clk and the returned cycle, check_ready() returns the same result for every command
+   * addressed to this subtree (unless a new command is issued in the meantime).
+   */
+  Clk_t get_next_ready_clk(Clk_t clk) {
+    DRAMFlatTiming& timing = m_spec->m_flat_timing;
+    const int num_cmds = T::m_commands.size();
+
+    Clk_t next_ready_clk = std::numeric_limits<Clk_t>::max();
+    // The subtree covers a contiguous range of flat ids at every level below this node
+    int first_id = m_flat_id;
+    int num_ids = 1;
+    for (int level = m_level; level < timing.m_num_nodes.size(); level++) {
+      for (int cmd = 0; cmd < num_cmds; cmd++) {
+        const Clk_t* ready_clks = &timing.ready_clk(level, cmd, m_channel_id, first_id);
+        for (int i = 0; i < num_ids; i++) {
+          if (ready_clks[i] > clk) {
+            next_ready_clk = std::min(next_ready_clk, ready_clks[i]);
+          }
         }
       }
-      return all_children_ready;
-    } else {
-      // SINGLE-PATH RECURSION:
-      int child_id = addr_h[m_level + 1];
-      if (child_id < 0 || child_id >= m_child_nodes.size()) {
-        spdlog::error("[check_ready] Invalid child_id {} at level {}. child_nodes size: {}", 
-                      child_id, m_level, m_child_nodes.size());
-        return false;
-      }
-      return m_child_nodes[child_id]->check_ready(command, addr_h, clk);
+      first_id *= timing.m_num_children[level];
+      num_ids *= timing.m_num_children[level];
     }
+    return next_ready_clk;
   };
 
   bool check_rowbuffer_hit(int command, const AddrHierarchy_t& addr_h, Clk_t m_clk) {
@@ -321,27 +580,65 @@ struct DRAMNodeBase {
     // recursively check for row hits at my child
     return m_child_nodes[child_id]->check_node_open(command, addr_h, m_clk);
   }
+
+  private:
+    // Whether the traversal of the command stops at the given level (its addressing level or a leaf)
+    bool is_path_end(int command, int level) {
+      return level == m_spec->m_command_addressing_level[command] || m_spec->m_flat_timing.m_num_children[level] == 0;
+    };
+
+    // Follows the single path of the address from (level, flat_id) until the path ends or stop_level is reached,
+    // accumulating the ready clocks of the command on the way. Returns false if the address is invalid.
+    bool descend(int command, const AddrHierarchy_t& addr_h, int stop_level, int& level, int& flat_id, Clk_t& ready_clk) {
+      DRAMFlatTiming& timing = m_spec->m_flat_timing;
+      while (level != stop_level && !is_path_end(command, level)) {
+        const int num_children = timing.m_num_children[level];
+        int child_id = addr_h[level + 1];
+        if (child_id < 0 || child_id >= num_children) {
+          spdlog::error("[get_ready_clk] Invalid child_id {} at level {}. child_nodes size: {}", 
+                        child_id, level, num_children);
+          return false;
+        }
+        flat_id = flat_id * num_children + child_id;
+        level++;
+        ready_clk = std::max(ready_clk, timing.ready_clk(level, command, m_channel_id, flat_id));
+      }
+      return true;
+    };
 };
 
+// The lambdas are plain function pointers (i.e., function templates or captureless lambdas), so that
+// invoking them is a direct indirect call without the type erasure of std::function
 template<class T>
-using ActionFunc_t = std::function<void(typename T::Node* node, int cmd, const AddrHierarchy_t& addr_h, Clk_t clk)>;
+using ActionFunc_t = void (*)(typename T::Node* node, int cmd, const AddrHierarchy_t& addr_h, Clk_t clk);
 template<class T>
-using PreqFunc_t   = std::function<int (typename T::Node* node, int cmd, const AddrHierarchy_t& addr_h, Clk_t clk)>;
+using PreqFunc_t   = int  (*)(typename T::Node* node, int cmd, const AddrHierarchy_t& addr_h, Clk_t clk);
 template<class T>
-using RowhitFunc_t = std::function<bool(typename T::Node* node, int cmd, int target_id, Clk_t clk)>;
+using RowhitFunc_t = bool (*)(typename T::Node* node, int cmd, int target_id, Clk_t clk);
 template<class T>
-using RowopenFunc_t = std::function<bool(typename T::Node* node, int cmd, int target_id, Clk_t clk)>;
+using RowopenFunc_t = bool (*)(typename T::Node* node, int cmd, int target_id, Clk_t clk);
 template<class T>
-using PowerFunc_t = std::function<void(typename T::Node* node, int cmd, const AddrHierarchy_t& addr_h, Clk_t clk)>;
+using PowerFunc_t = void (*)(typename T::Node* node, int cmd, const AddrHierarchy_t& addr_h, Clk_t clk);
 
+/**
+ * @brief    A dense (level x command) table of lambdas, looked up as matrix[level][command]
+ * 
+ */
 template<typename T>
-using FuncMatrix = std::vector<std::vector<T>>;
-
-// TODO: Enable easy syntax for FuncMatrix lookup
-// template<typename T, int N, int M>
-// class FuncMatrix : public std::array<std::array<T, M>, N> {
-
-// };
+class FuncMatrix {
+  public:
+    void resize(int num_levels, int num_cmds) {
+      m_num_cmds = num_cmds;
+      m_funcs.assign((size_t) num_levels * num_cmds, nullptr);
+    };
+
+    T* operator[](int level) { return &m_funcs[(size_t) level * m_num_cmds]; };
+    const T* operator[](int level) const { return &m_funcs[(size_t) level * m_num_cmds]; };
+
+  private:
+    int m_num_cmds = 0;
+    std::vector<T> m_funcs;
+};
 
 }        // namespace Ramulator
 
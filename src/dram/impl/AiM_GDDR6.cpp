@@ -53,8 +53,7 @@ class GDDR6 : public IDRAM, public Implementation {
       "MACSB", "AFSB", "RDCP", "WRCP",
       // Multi-bank AiM commands
       "ACT4_BG", "PRE4_BG", "MAC4B_INTRA", "AF4B_INTRA", "EWMUL", "EWADD",
-      // TODO: 4-bank commands for inter-bank group
-      // "ACT4_BKS", "ACTAF4_BKS", "PRE4_BKS", "MAC4B_INTER", "AF4B_INTER",
+      "ACT4_BKS", "PRE4_BKS", "MAC4B_INTER", "AF4B_INTER",
       "ACT16", "MACAB", "AFAB", "WRAFLUT", "WRBK",
       // No-bank AiM commands
       "WRGB", "WRMAC", "WRBIAS", "RDMAC", "RDAF",
@@ -71,9 +70,8 @@ class GDDR6 : public IDRAM, public Implementation {
         // Multi-bank AiM commands
         {"ACT4_BG", "row"}, {"PRE4_BG", "bank"},
         {"MAC4B_INTRA", "column"}, {"AF4B_INTRA", "column"}, {"EWMUL", "column"}, {"EWADD", "column"}, 
-        // TODO: 4-bank commands for inter-bank group
-        // {"ACT4_BKS", "row"}, {"ACTAF4_BKS", "row"}, {"PRE4_BKS", "bank"},
-        // {"MAC4B_INTER", "column"}, {"AF4B_INTER", "column"},
+        {"ACT4_BKS", "row"}, {"PRE4_BKS", "bank"},
+        {"MAC4B_INTER", "column"}, {"AF4B_INTER", "column"},
         {"ACT16", "row"}, {"MACAB", "column"},  {"AFAB", "column"},
         {"WRAFLUT", "row"},  {"WRBK", "column"},
         // No-bank AiM commands
@@ -93,9 +91,9 @@ class GDDR6 : public IDRAM, public Implementation {
         // 4-bank commands for intra-bank group
         {"ACT4_BG", "bankgroup"}, {"PRE4_BG", "bankgroup"},
         {"MAC4B_INTRA", "bankgroup"}, {"AF4B_INTRA", "bankgroup"}, {"EWMUL", "bankgroup"}, {"EWADD", "bankgroup"},
-        // TODO: 4-bank commands for inter-bank group
-        // {"ACT4_BKS", "bank"}, {"ACTAF4_BKS", "bank"}, {"PRE4_BKS", "bank"},
-        // {"MAC4B_INTER", "bank"}, {"AF4B_INTER", "bank"}, {"EWMUL", "bank"}, {"EWADD", "bank"},
+        // 4-bank commands for inter-bank group (the same bank of every bankgroup)
+        {"ACT4_BKS", "channel"}, {"PRE4_BKS", "channel"},
+        {"MAC4B_INTER", "channel"}, {"AF4B_INTER", "channel"},
         // all-bank commands
         {"ACT16", "channel"}, {"MACAB", "channel"}, {"AFAB", "channel"}, 
         {"WRAFLUT", "channel"}, {"WRBK", "channel"},
@@ -107,7 +105,7 @@ class GDDR6 : public IDRAM, public Implementation {
 
     inline static const ImplLUT m_command_meta = LUT<DRAMCommandMeta> (
       m_commands, {
-                         // open?   close?   access?  refresh?
+                         // open?   close?   access?  refresh? same-bank?
         {"ACT",            {true,   false,   false,   false}},
         {"PREA",           {false,  true,    false,   false}},
         {"PRE",            {false,  true,    false,   false}},
@@ -131,12 +129,10 @@ class GDDR6 : public IDRAM, public Implementation {
         {"AF4B_INTRA" ,    {false,  false,   true,    false}},
         {"EWMUL",          {false,  false,   true,    false}},
         {"EWADD",          {false,  false,   true,    false}},
-        // TODO: 4-bank commands for inter-bank group
-        // {"ACT4_BKS",    {true,   false,   false,   false}},
-        // {"ACTAF4_BKS",  {true,   false,   false,   false}},
-        // {"PRE4_BKS",    {false,  true,    false,   false}},
-        // {"MAC4B_INTER", {false,  false,   true,    false}},
-        // {"AF4B_INTER",  {false,  false,   true,    false}},
+        {"ACT4_BKS",       {true,   false,   false,   false,   true }},
+        {"PRE4_BKS",       {false,  true,    false,   false,   true }},
+        {"MAC4B_INTER",    {false,  false,   true,    false,   true }},
+        {"AF4B_INTER",     {false,  false,   true,    false,   true }},
         {"ACT16",          {true,   false,   false,   false}},
         {"MACAB",          {false,  false,   true,    false}},
         {"AFAB" ,          {false,  false,   true,    false}},
@@ -152,12 +148,13 @@ class GDDR6 : public IDRAM, public Implementation {
     );
 
     inline static constexpr ImplDef m_requests = {
-      "read", "write", "all-bank-refresh", "PREsb"
+      "read", "write", "all-bank-refresh", "PREsb", "per-bank-refresh"
     };
 
     inline static const ImplLUT m_request_translations = LUT (
       m_requests, m_commands, {
         {"read", "RD"}, {"write", "WR"}, {"all-bank-refresh", "REFab"}, {"PREsb", "PRE"},
+        {"per-bank-refresh", "REFpb"},
       }
     );
 
@@ -166,11 +163,11 @@ class GDDR6 : public IDRAM, public Implementation {
       "MAC_SBK", "AF_SBK", "COPY_BKGB", "COPY_GBBK",
       // Multi-bank AiM commands
       "MAC_4BK_INTRA_BG", "AF_4BK_INTRA_BG", "EWMUL", "EWADD",
-      // TODO: 4-bank commands for inter-bank group
-      // "MAC_4BK_INTER_BG", "AF_4BK_INTER_BG",
       "MAC_ABK", "AF_ABK", "WR_AFLUT", "WR_BK",
       // AiM DMA commands
-      "WR_GB", "WR_MAC", "WR_BIAS", "RD_MAC", "RD_AF"
+      "WR_GB", "WR_MAC", "WR_BIAS", "RD_MAC", "RD_AF",
+      // Follows the order of Request::Type
+      "MAC_4BK_INTER_BG", "AF_4BK_INTER_BG",
     };
 
     inline static const ImplLUT m_aim_req_translation = LUT (
@@ -179,8 +176,7 @@ class GDDR6 : public IDRAM, public Implementation {
         {"MAC_SBK", "MACSB"}, {"AF_SBK", "AFSB"}, {"COPY_BKGB", "RDCP"}, {"COPY_GBBK", "WRCP"},
         // Multi-bank AiM commands
         {"MAC_4BK_INTRA_BG", "MAC4B_INTRA"}, {"AF_4BK_INTRA_BG", "AF4B_INTRA"}, {"EWMUL", "EWMUL"}, {"EWADD", "EWADD"},
-        // TODO: 4-bank commands for inter-bank group
-        // {"MAC_4BK_INTER_BG", "MAC4B_INTER"}, {"AF_4BK_INTER_BG", "AF4B_INTER"}, 
+        {"MAC_4BK_INTER_BG", "MAC4B_INTER"}, {"AF_4BK_INTER_BG", "AF4B_INTER"},
         {"MAC_ABK", "MACAB"}, {"AF_ABK", "AFAB"}, {"WR_AFLUT", "WRAFLUT"}, {"WR_BK", "WRBK"},
         // AiM DMA commands
         {"WR_GB", "WRGB"}, {"WR_MAC", "WRMAC"}, {"WR_BIAS", "WRBIAS"},
@@ -203,7 +199,7 @@ class GDDR6 : public IDRAM, public Implementation {
       "nRRDS", "nRRDL",
       "nWTRS", "nWTRL",
       "nFAW",
-      "nRFC","nREFI", "nRREFD", "nRFCpb",
+      "nRFC", "nRFCpb", "nRREFD", "nREFI",
       // AiM
       "nRCDRDMAC", "nRCDRDAF", "nRCDRDCP", "nRCDWRCP", "nRCDEWMUL",
       "nCLGB", "nCLREG", "nCWLGB", "nCWLREG", "nWPRE",
@@ -232,6 +228,15 @@ class GDDR6 : public IDRAM, public Implementation {
       Node(GDDR6* dram, Node* parent, int level, int id) : DRAMNodeBase<GDDR6>(dram, parent, level, id) {};
     };
     std::vector<Node*> m_channels;
+    DRAMFlatTiming m_flat_timing;
+    DRAMOpenRows m_open_row_ids;
+    // Bumped whenever a command or a future action updates the node states/timing of a channel
+    std::vector<int64_t> m_state_versions;
+    std::vector<int64_t> m_timing_versions;
+    // Masks of the m_open_rows bits (one per bank of a channel, bankgroup-major)
+    uint16_t m_all_banks_mask = 0;
+    std::vector<uint16_t> m_bankgroup_masks;   // All banks of a bankgroup
+    std::vector<uint16_t> m_same_bank_masks;   // The same bank of every bankgroup
 
     FuncMatrix<ActionFunc_t<Node>>  m_actions;
     FuncMatrix<PreqFunc_t<Node>>    m_preqs;
@@ -243,21 +248,22 @@ class GDDR6 : public IDRAM, public Implementation {
       m_clk++;
 
       // Process future actions (e.g., REFab_end after nRFCab cycles)
-      for (int i = m_future_actions.size() - 1; i >= 0; i--) {
-        auto& future_action = m_future_actions[i];
-        if (future_action.clk == m_clk) {
+      FutureAction future_action;
+      for (auto& channel_future_actions : m_future_actions) {
+        while (channel_future_actions.pop_due(m_clk, future_action)) {
           int channel_id = future_action.addr_h[m_levels["channel"]];
 
           DEBUG_LOG(GDDR6, m_logger,
                     "[AiMulator: GDDR6 tick()] EXECUTING future action: cmd={}, channel={}, cycle={}",
-                    m_commands(future_action), channel_id, m_clk);
+                    m_commands(future_action.cmd), channel_id, m_clk);
+
+          if (m_channels[channel_id]->update_states(future_action.cmd, future_action.addr_h, m_clk)) {
+            m_state_versions[channel_id]++;
+          }
 
-          m_channels[channel_id]->update_states(future_action.cmd, future_action.addr_h, m_clk);
-          m_future_actions.erase(m_future_actions.begin() + i);
-          
           DEBUG_LOG(GDDR6, m_logger,
                     "[AiMulator: GDDR6 tick()] Future action executed and removed. Remaining: {}",
-                    m_future_actions.size());
+                    channel_future_actions.size());
         }
       }
     };
@@ -286,7 +292,10 @@ class GDDR6 : public IDRAM, public Implementation {
     void issue_command(int command, const AddrHierarchy_t& addr_h) override {
       int channel_id = addr_h[m_levels["channel"]];
       m_channels[channel_id]->update_timing(command, addr_h, m_clk);
-      m_channels[channel_id]->update_states(command, addr_h, m_clk);
+      m_timing_versions[channel_id]++;
+      if (m_channels[channel_id]->update_states(command, addr_h, m_clk)) {
+        m_state_versions[channel_id]++;
+      }
       switch (command)
       {
       case m_commands["PREA"]: {
@@ -295,32 +304,40 @@ class GDDR6 : public IDRAM, public Implementation {
       }
       case m_commands["PRE4_BG"]: {
         int bankgroup_id = addr_h[m_levels["bankgroup"]];
-        for (int bank_id = bankgroup_id * 4; bank_id < (bankgroup_id + 1) * 4; bank_id++) {
-          m_open_rows[channel_id] &= ~((uint16_t)(1 << bank_id));
-        }
+        m_open_rows[channel_id] &= ~m_bankgroup_masks[bankgroup_id];
+        break;
+      }
+      case m_commands["PRE4_BKS"]: {
+        int bank_id = addr_h[m_levels["bank"]];
+        m_open_rows[channel_id] &= ~m_same_bank_masks[bank_id];
         break;
       }
       case m_commands["PRE"]:
       case m_commands["RDA"]:
       case m_commands["WRA"]: {
+        int bankgroup_id = addr_h[m_levels["bankgroup"]];
         int bank_id = addr_h[m_levels["bank"]];
-        m_open_rows[channel_id] &= ~((uint16_t)(1 << bank_id));
+        m_open_rows[channel_id] &= ~(m_bankgroup_masks[bankgroup_id] & m_same_bank_masks[bank_id]);
         break;
       }
       case m_commands["ACT16"]: {
-        m_open_rows[channel_id] = (uint16_t)(0xFFFF);
+        m_open_rows[channel_id] = m_all_banks_mask;
         break;
       }
       case m_commands["ACT4_BG"]: {
         int bankgroup_id = addr_h[m_levels["bankgroup"]];
-        for (int bank_id = bankgroup_id * 4; bank_id < (bankgroup_id + 1) * 4; bank_id++) {
-          m_open_rows[channel_id] |= ((uint16_t)(1 << bank_id));
-        }
+        m_open_rows[channel_id] |= m_bankgroup_masks[bankgroup_id];
+        break;
+      }
+      case m_commands["ACT4_BKS"]: {
+        int bank_id = addr_h[m_levels["bank"]];
+        m_open_rows[channel_id] |= m_same_bank_masks[bank_id];
         break;
       }
       case m_commands["ACT"]: {
+        int bankgroup_id = addr_h[m_levels["bankgroup"]];
         int bank_id = addr_h[m_levels["bank"]];
-        m_open_rows[channel_id] |= (uint16_t)(1 << bank_id);
+        m_open_rows[channel_id] |= m_bankgroup_masks[bankgroup_id] & m_same_bank_masks[bank_id];
         break;
       }
       case m_commands["REFab"]: {
@@ -331,11 +348,11 @@ class GDDR6 : public IDRAM, public Implementation {
                   "[AiMulator: GDDR6 issue_command()] REFab issued at cycle={}. Scheduling REFab_end for cycle={}, (nRFC={}), channel={}",
                   m_clk, refab_end_cycle, m_timing_vals("nRFC"), addr_h[m_levels["channel"]]);
         
-        m_future_actions.push_back({m_commands["REFab_end"], addr_h, m_clk + m_timing_vals("nRFC") - 1});
+        m_future_actions[channel_id].push({m_commands["REFab_end"], addr_h, m_clk + m_timing_vals("nRFC") - 1});
 
         DEBUG_LOG(LPDDR5, m_logger,
                   "[AiMulator: GDDR6 issue_command()] Future actions count after REFab: {}",
-                  m_future_actions.size());
+                  m_future_actions[channel_id].size());
         break;
       }
       default:
@@ -363,6 +380,23 @@ class GDDR6 : public IDRAM, public Implementation {
       return m_channels[channel_id]->check_node_open(command, addr_h, m_clk);
     };
 
+    Clk_t get_next_ready_clk(int channel_id) override {
+      return m_channels[channel_id]->get_next_ready_clk(m_clk);
+    };
+
+    Clk_t get_ready_clk(int command, const AddrHierarchy_t& addr_h) override {
+      int channel_id = addr_h[m_levels["channel"]];
+      return m_channels[channel_id]->get_ready_clk(command, addr_h);
+    };
+
+    int64_t get_timing_version(int channel_id) override {
+      return m_timing_versions[channel_id];
+    };
+
+    int64_t get_state_version(int channel_id) override {
+      return m_state_versions[channel_id];
+    };
+
   private:
     void set_organization() {
       // Channel width
@@ -539,6 +573,8 @@ class GDDR6 : public IDRAM, public Implementation {
       m_command_latencies("WRCP")  = 1;
       m_command_latencies("MAC4B_INTRA") = 1;
       m_command_latencies("AF4B_INTRA")  = 1;
+      m_command_latencies("MAC4B_INTER") = 1;
+      m_command_latencies("AF4B_INTER")  = 1;
       m_command_latencies("MACAB") = 1;
       m_command_latencies("AFAB")  = 1;
       m_command_latencies("EWMUL") = 1;
@@ -580,21 +616,21 @@ class GDDR6 : public IDRAM, public Implementation {
          *************************************************************/
         // ACT <-> ACT
         {.level = "channel", .preceding = {"ACT16"}, .following = {"ACT16"}, .latency = V("nRRDS")},
-        {.level = "channel", .preceding = {"ACT4_BG"}, .following = {"ACT", "ACT4_BG"}, .latency = V("nRRDS")},
-        {.level = "channel", .preceding = {"ACT"}, .following = {"ACT4_BG"}, .latency = V("nRRDS")},
+        {.level = "channel", .preceding = {"ACT4_BG", "ACT4_BKS"}, .following = {"ACT", "ACT4_BG", "ACT4_BKS"}, .latency = V("nRRDS")},
+        {.level = "channel", .preceding = {"ACT"}, .following = {"ACT4_BG", "ACT4_BKS"}, .latency = V("nRRDS")},
         // ACT <-> PRE
-        {.level = "channel", .preceding = {"ACT", "ACT4_BG", "ACT16"}, .following = {"PREA"}, .latency = V("nRAS")},
-        {.level = "channel", .preceding = {"ACT16"}, .following = {"PRE4_BG"}, .latency = V("nRAS")},
-        {.level = "channel", .preceding = {"PRE", "PRE4_BG", "PREA"}, .following = {"ACT16"}, .latency = V("nRP")},
-        {.level = "channel", .preceding = {"PRE4_BG", "PREA"}, .following = {"ACT"}, .latency = V("nRP")},
+        {.level = "channel", .preceding = {"ACT", "ACT4_BG", "ACT4_BKS", "ACT16"}, .following = {"PREA"}, .latency = V("nRAS")},
+        {.level = "channel", .preceding = {"ACT16"}, .following = {"PRE4_BG", "PRE4_BKS"}, .latency = V("nRAS")},
+        {.level = "channel", .preceding = {"PRE", "PRE4_BG", "PRE4_BKS", "PREA"}, .following = {"ACT16"}, .latency = V("nRP")},
+        {.level = "channel", .preceding = {"PRE4_BG", "PRE4_BKS", "PREA"}, .following = {"ACT"}, .latency = V("nRP")},
         /************************************************************
          * CAS <-> RAS
          *************************************************************/
-        {.level = "channel", .preceding = {"ACT16"}, .following = {"RD", "RDA", "MACSB", "AFSB", "RDCP", "MAC4B_INTRA", "EWMUL", "EWADD", "MACAB"}, .latency = V("nRCDRD")},
+        {.level = "channel", .preceding = {"ACT16"}, .following = {"RD", "RDA", "MACSB", "AFSB", "RDCP", "MAC4B_INTRA", "MAC4B_INTER", "EWMUL", "EWADD", "MACAB"}, .latency = V("nRCDRD")},
         {.level = "channel", .preceding = {"ACT16"}, .following = {"WR", "WRA", "WRCP", "WRBK"}, .latency = V("nRCDWR")},
-        {.level = "channel", .preceding = {"RD", "MACSB", "AFSB", "RDCP", "MAC4B_INTRA", "AF4B_INTRA", "EWMUL", "EWADD", "MACAB", "AFAB"}, .following = {"PREA"}, .latency = V("nRTP")},
+        {.level = "channel", .preceding = {"RD", "MACSB", "AFSB", "RDCP", "MAC4B_INTRA", "AF4B_INTRA", "MAC4B_INTER", "AF4B_INTER", "EWMUL", "EWADD", "MACAB", "AFAB"}, .following = {"PREA"}, .latency = V("nRTP")},
         {.level = "channel", .preceding = {"WR", "WRCP", "WRAFLUT", "WRBK"}, .following = {"PREA"}, .latency = V("nCWL")+V("nBL")+V("nWR")},
-        {.level = "channel", .preceding = {"MACAB", "AFAB"}, .following = {"PRE4_BG"}, .latency = V("nRTP")},
+        {.level = "channel", .preceding = {"MACAB", "AFAB"}, .following = {"PRE4_BG", "PRE4_BKS"}, .latency = V("nRTP")},
         {.level = "channel", .preceding = {"RDA"}, .following = {"ACT16"}, .latency = V("nRTP")+V("nRP")},
         {.level = "channel", .preceding = {"WRA"}, .following = {"ACT16"}, .latency = V("nCWL")+V("nBL")+V("nWR")+V("nRP")},
         /************************************************************
@@ -604,14 +640,14 @@ class GDDR6 : public IDRAM, public Implementation {
          * - AiM RD: MACAB, AFAB, MAC4B_INTRA, AF4B_INTRA, MACSB, AFSB
          * - AiM WR: WRCP
          ************************************************************/
-        {.level = "channel", .preceding = {"RD", "RDA", "MACSB", "AFSB", "RDCP", "MAC4B_INTRA", "AF4B_INTRA", "EWMUL", "EWADD", "MACAB", "AFAB"}, .following = {"RD", "RDA", "MACSB", "AFSB", "RDCP", "MAC4B_INTRA", "MAC4B_INTRA", "AF4B_INTRA", "EWMUL", "EWADD", "MACAB", "AFAB"}, .latency = V("nCCDS")},
+        {.level = "channel", .preceding = {"RD", "RDA", "MACSB", "AFSB", "RDCP", "MAC4B_INTRA", "AF4B_INTRA", "MAC4B_INTER", "AF4B_INTER", "EWMUL", "EWADD", "MACAB", "AFAB"}, .following = {"RD", "RDA", "MACSB", "AFSB", "RDCP", "MAC4B_INTRA", "MAC4B_INTRA", "AF4B_INTRA", "MAC4B_INTER", "AF4B_INTER", "EWMUL", "EWADD", "MACAB", "AFAB"}, .latency = V("nCCDS")},
         {.level = "channel", .preceding = {"WR", "WRA", "WRCP", "WRAFLUT", "WRBK"}, .following = {"WR", "WRA", "WRCP", "WRAFLUT", "WRBK"}, .latency = V("nCCDS")},
         /************************************************************
          * RD -> WR, Assuming tWPRE = 1 tCK
          * Minimum Read to Write, tRTW
          *************************************************************/
         // + 1 for assuming bus turn around time
-        {.level = "channel", .preceding = {"RD", "RDA", "MACSB", "AFSB", "RDCP", "MAC4B_INTRA", "AF4B_INTRA", "EWMUL", "EWADD", "MACAB", "AFAB"}, .following = {"WR", "WRA", "WRCP", "WRAFLUT", "WRBK"}, .latency = V("nCL")+V("nBL")+3-V("nCWL")+V("nWPRE")},
+        {.level = "channel", .preceding = {"RD", "RDA", "MACSB", "AFSB", "RDCP", "MAC4B_INTRA", "AF4B_INTRA", "MAC4B_INTER", "AF4B_INTER", "EWMUL", "EWADD", "MACAB", "AFAB"}, .following = {"WR", "WRA", "WRCP", "WRAFLUT", "WRBK"}, .latency = V("nCL")+V("nBL")+3-V("nCWL")+V("nWPRE")},
         // No-bank
         // {.level = "channel", .preceding = {"RDMAC, RDAF"}, .following = {"WR", "WRA", "WRCP"}, .latency = V("nCLREG")+V("nBL")+3-V("nCWL")+V("nWPRE")},
         // {.level = "channel", .preceding = {"RDMAC, RDAF"}, .following = {"WRGB"}, .latency = V("nCLREG")+V("nBL")+3-V("nCWLGB")+V("nWPRE")},
@@ -620,18 +656,18 @@ class GDDR6 : public IDRAM, public Implementation {
          * WR -> RD
          * Minimum Read after Write
          *************************************************************/
-        {.level = "channel", .preceding = {"WR", "WRA", "WRCP", "WRAFLUT", "WRBK"}, .following = {"RD", "RDA", "MACSB", "AFSB", "RDCP", "MAC4B_INTRA", "AF4B_INTRA", "EWMUL", "EWADD", "MACAB", "AFAB"}, .latency = V("nCWL")+V("nBL")+V("nWTRS")},
+        {.level = "channel", .preceding = {"WR", "WRA", "WRCP", "WRAFLUT", "WRBK"}, .following = {"RD", "RDA", "MACSB", "AFSB", "RDCP", "MAC4B_INTRA", "AF4B_INTRA", "MAC4B_INTER", "AF4B_INTER", "EWMUL", "EWADD", "MACAB", "AFAB"}, .latency = V("nCWL")+V("nBL")+V("nWTRS")},
         // No-bank
-        // {.level = "channel", .preceding = {"WRGB"}, .following = {"RD", "RDA", "MACSB", "AFSB", "RDCP", "MAC4B_INTRA", "AF4B_INTRA", "MACAB", "AFAB"}, .latency = V("nCWLGB")+V("nBL")+V("nWTRS")},
-        // {.level = "channel", .preceding = {"WRMAC"}, .following = {"RD", "RDA", "MACSB", "AFSB", "RDCP", "MAC4B_INTRA", "AF4B_INTRA", "MACAB", "AFAB"}, .latency = V("nCWLREG")+V("nBL")+V("nWTRS")},
+        // {.level = "channel", .preceding = {"WRGB"}, .following = {"RD", "RDA", "MACSB", "AFSB", "RDCP", "MAC4B_INTRA", "AF4B_INTRA", "MAC4B_INTER", "AF4B_INTER", "MACAB", "AFAB"}, .latency = V("nCWLGB")+V("nBL")+V("nWTRS")},
+        // {.level = "channel", .preceding = {"WRMAC"}, .following = {"RD", "RDA", "MACSB", "AFSB", "RDCP", "MAC4B_INTRA", "AF4B_INTRA", "MAC4B_INTER", "AF4B_INTER", "MACAB", "AFAB"}, .latency = V("nCWLREG")+V("nBL")+V("nWTRS")},
         /************************************************************
          * RAS -> REF
          *************************************************************/
-        {.level = "channel", .preceding = {"ACT", "ACT4_BG", "ACT16"}, .following = {"REFab"}, .latency = V("nRC")},
-        {.level = "channel", .preceding = {"PRE", "PRE4_BG", "PREA"}, .following = {"REFab"}, .latency = V("nRP")},
+        {.level = "channel", .preceding = {"ACT", "ACT4_BG", "ACT4_BKS", "ACT16"}, .following = {"REFab"}, .latency = V("nRC")},
+        {.level = "channel", .preceding = {"PRE", "PRE4_BG", "PRE4_BKS", "PREA"}, .following = {"REFab"}, .latency = V("nRP")},
         {.level = "channel", .preceding = {"RDA"}, .following = {"REFab"}, .latency = V("nRP")+V("nRTP")},
         {.level = "channel", .preceding = {"WRA"}, .following = {"REFab"}, .latency = V("nCWL")+V("nBL")+V("nWR")+V("nRP")},
-        {.level = "channel", .preceding = {"REFab"}, .following = {"REFab", "ACT", "ACT4_BG", "ACT16", "PRE", "PRE4_BG", "PREA"}, .latency = V("nRFC")},
+        {.level = "channel", .preceding = {"REFab"}, .following = {"REFab", "ACT", "ACT4_BG", "ACT4_BKS", "ACT16", "PRE", "PRE4_BG", "PRE4_BKS", "PREA"}, .latency = V("nRFC")},
         /************************************************************
          * RAS -> REFp2b
          *************************************************************/
@@ -656,17 +692,17 @@ class GDDR6 : public IDRAM, public Implementation {
          * AiM RAS: ACT4, PRE4_BG
          *************************************************************/
         {.level = "bankgroup", .preceding = {"ACT"}, .following = {"ACT"}, .latency = V("nRRDL")},
-        {.level = "bankgroup", .preceding = {"ACT", "ACT4_BG"}, .following = {"PRE4_BG"}, .latency = V("nRAS")},
-        {.level = "bankgroup", .preceding = {"PRE", "PRE4_BG", "PREA"}, .following = {"ACT4_BG"}, .latency = V("nRP")},
+        {.level = "bankgroup", .preceding = {"ACT", "ACT4_BG", "ACT4_BKS"}, .following = {"PRE4_BG", "PRE4_BKS"}, .latency = V("nRAS")},
+        {.level = "bankgroup", .preceding = {"PRE", "PRE4_BG", "PRE4_BKS", "PREA"}, .following = {"ACT4_BG", "ACT4_BKS"}, .latency = V("nRP")},
         /************************************************************
          * CAS <-> RAS
          ************************************************************/
-        {.level = "bankgroup", .preceding = {"ACT4_BG"}, .following = {"RD", "RDA", "MACSB", "AFSB", "RDCP", "MAC4B_INTRA", "EWMUL", "EWADD"}, .latency = V("nRCDRD")},
-        {.level = "bankgroup", .preceding = {"ACT4_BG"}, .following = {"WR", "WRA", "WRCP"}, .latency = V("nRCDWR")},
-        {.level = "bankgroup", .preceding = {"RD", "MACSB", "AFSB", "RDCP", "MAC4B_INTRA", "AF4B_INTRA", "EWMUL", "EWADD"}, .following = {"PRE4_BG"}, .latency = V("nRTP")},
-        {.level = "bankgroup", .preceding = {"WR", "WRCP", "WRAFLUT", "WRBK"}, .following = {"PRE4_BG"}, .latency = V("nCWL")+V("nBL")+V("nWR")},
-        {.level = "bankgroup", .preceding = {"RDA"}, .following = {"ACT4_BG"}, .latency = V("nRTP")+V("nRP")},
-        {.level = "bankgroup", .preceding = {"WRA"}, .following = {"ACT4_BG"}, .latency = V("nCWL")+V("nBL")+V("nWR")+V("nRP")},
+        {.level = "bankgroup", .preceding = {"ACT4_BG", "ACT4_BKS"}, .following = {"RD", "RDA", "MACSB", "AFSB", "RDCP", "MAC4B_INTRA", "MAC4B_INTER", "EWMUL", "EWADD"}, .latency = V("nRCDRD")},
+        {.level = "bankgroup", .preceding = {"ACT4_BG", "ACT4_BKS"}, .following = {"WR", "WRA", "WRCP"}, .latency = V("nRCDWR")},
+        {.level = "bankgroup", .preceding = {"RD", "MACSB", "AFSB", "RDCP", "MAC4B_INTRA", "AF4B_INTRA", "MAC4B_INTER", "AF4B_INTER", "EWMUL", "EWADD"}, .following = {"PRE4_BG", "PRE4_BKS"}, .latency = V("nRTP")},
+        {.level = "bankgroup", .preceding = {"WR", "WRCP", "WRAFLUT", "WRBK"}, .following = {"PRE4_BG", "PRE4_BKS"}, .latency = V("nCWL")+V("nBL")+V("nWR")},
+        {.level = "bankgroup", .preceding = {"RDA"}, .following = {"ACT4_BG", "ACT4_BKS"}, .latency = V("nRTP")+V("nRP")},
+        {.level = "bankgroup", .preceding = {"WRA"}, .following = {"ACT4_BG", "ACT4_BKS"}, .latency = V("nCWL")+V("nBL")+V("nWR")+V("nRP")},
         /************************************************************
          * CAS -> CAS
          * nCCDL is the minimal latency between two successive distinct column commands that access to the SAME bankgroup
@@ -684,33 +720,34 @@ class GDDR6 : public IDRAM, public Implementation {
          * RAS -> RAS
          * A minimum time, tRAS, must have elapsed between opening and closing a row.
          *************************************************************/
-        {.level = "bank", .preceding = {"ACT", "ACT4_BG", "ACT16"}, .following = {"PRE"}, .latency = V("nRAS")},
-        {.level = "bank", .preceding = {"PRE"}, .following = {"ACT"}, .latency = V("nRP")},
+        {.level = "bank", .preceding = {"ACT", "ACT4_BG", "ACT4_BKS", "ACT16"}, .following = {"PRE", "PRE4_BKS"}, .latency = V("nRAS")},
+        {.level = "bank", .preceding = {"PRE", "PRE4_BKS"}, .following = {"ACT", "ACT4_BKS"}, .latency = V("nRP")},
          /************************************************************
          * CAS -> RAS
          * An ACTIVATE (ACT) command is required to be issued before the READ command to the same bank, and tRCDRD must be met.
          *************************************************************/
         {.level = "bank", .preceding = {"ACT"}, .following = {"RD", "RDA", "MACSB", "AFSB", "RDCP"}, .latency = V("nRCDRD")},
+        {.level = "bank", .preceding = {"ACT4_BKS"}, .following = {"MAC4B_INTER", "AF4B_INTER"}, .latency = V("nRCDRD")},
         {.level = "bank", .preceding = {"ACT"}, .following = {"WR", "WRA", "WRCP"},                  .latency = V("nRCDWR")},
-        {.level = "bank", .preceding = {"RD", "MACSB", "AFSB", "RDCP", "MAC4B_INTRA", "AF4B_INTRA", "EWMUL", "EWADD", "MACAB", "AFAB"}, .following = {"PRE"}, .latency = V("nRTP")},
-        {.level = "bank", .preceding = {"WR", "WRCP", "WRAFLUT", "WRBK"}, .following = {"PRE"}, .latency = V("nCWL")+V("nBL")+V("nWR")},
+        {.level = "bank", .preceding = {"RD", "MACSB", "AFSB", "RDCP", "MAC4B_INTRA", "AF4B_INTRA", "MAC4B_INTER", "AF4B_INTER", "EWMUL", "EWADD", "MACAB", "AFAB"}, .following = {"PRE", "PRE4_BKS"}, .latency = V("nRTP")},
+        {.level = "bank", .preceding = {"WR", "WRCP", "WRAFLUT", "WRBK"}, .following = {"PRE", "PRE4_BKS"}, .latency = V("nCWL")+V("nBL")+V("nWR")},
         {.level = "bank", .preceding = {"RDA"}, .following = {"ACT"}, .latency = V("nRTP")+V("nRP")},
         {.level = "bank", .preceding = {"WRA"}, .following = {"ACT"}, .latency = V("nCWL")+V("nBL")+V("nWR")+V("nRP")},
         /************************************************************
          * RAS -> REFpb
          * The selected bank must be precharged prior to the REFpb command.
          *************************************************************/
-        {.level = "bank", .preceding = {"ACT", "ACT4_BG", "ACT16"}, .following = {"REFpb"}, .latency = V("nRC")},
-        {.level = "bank", .preceding = {"PRE", "PRE4_BG", "PREA"}, .following = {"REFpb"}, .latency = V("nRP")},
+        {.level = "bank", .preceding = {"ACT", "ACT4_BG", "ACT4_BKS", "ACT16"}, .following = {"REFpb"}, .latency = V("nRC")},
+        {.level = "bank", .preceding = {"PRE", "PRE4_BG", "PRE4_BKS", "PREA"}, .following = {"REFpb"}, .latency = V("nRP")},
         {.level = "bank", .preceding = {"RDA"}, .following = {"REFpb"}, .latency = V("nRP")+V("nRTP")},
         {.level = "bank", .preceding = {"WRA"}, .following = {"REFpb"}, .latency = V("nCWL")+V("nBL")+V("nWR")+V("nRP")},
-        {.level = "bank", .preceding = {"REFpb"}, .following = {"ACT", "ACT4_BG", "ACT16"}, .latency = V("nRFCpb")},
+        {.level = "bank", .preceding = {"REFpb"}, .following = {"ACT", "ACT4_BG", "ACT4_BKS", "ACT16"}, .latency = V("nRFCpb")},
       });
       #undef V
     };
 
     void set_actions() {
-      m_actions.resize(m_levels.size(), std::vector<ActionFunc_t<Node>>(m_commands.size()));
+      m_actions.resize(m_levels.size(), m_commands.size());
 
       // Channel Actions 
       m_actions[m_levels["channel"]][m_commands["PREA"]]  = Lambdas::Action::Channel::PREab<GDDR6>;
@@ -718,6 +755,9 @@ class GDDR6 : public IDRAM, public Implementation {
       m_actions[m_levels["channel"]][m_commands["REFab_end"]] = Lambdas::Action::Channel::REFab_end<GDDR6>;
       // Channel actions; AiM
       m_actions[m_levels["channel"]][m_commands["ACT16"]] = Lambdas::Action::Channel::ACTab<GDDR6>;
+      // The children of the channel are the bankgroups, as those of the LPDDR5 rank
+      m_actions[m_levels["channel"]][m_commands["ACT4_BKS"]] = Lambdas::Action::Rank::ACT4b_sb<GDDR6>;
+      m_actions[m_levels["channel"]][m_commands["PRE4_BKS"]] = Lambdas::Action::Rank::PRE4b_sb<GDDR6>;
 
       // Bankgroup actions; AiM
       m_actions[m_levels["bankgroup"]][m_commands["PRE4_BG"]] = Lambdas::Action::BankGroup::PRE4b_bg<GDDR6>;
@@ -731,7 +771,7 @@ class GDDR6 : public IDRAM, public Implementation {
     };
 
     void set_preqs() {
-      m_preqs.resize(m_levels.size(), std::vector<PreqFunc_t<Node>>(m_commands.size()));
+      m_preqs.resize(m_levels.size(), m_commands.size());
 
       // Channel actions; ramulator
       m_preqs[m_levels["channel"]][m_commands["REFab"]] = Lambdas::Preq::Channel::RequireAllBanksClosed<GDDR6>; 
@@ -740,6 +780,9 @@ class GDDR6 : public IDRAM, public Implementation {
       m_preqs[m_levels["channel"]][m_commands["AFAB"]]    = Lambdas::Preq::Channel::RequireAllRowsOpen<GDDR6>;
       m_preqs[m_levels["channel"]][m_commands["WRAFLUT"]] = Lambdas::Preq::Channel::RequireAllRowsOpen<GDDR6>;
       m_preqs[m_levels["channel"]][m_commands["WRBK"]]    = Lambdas::Preq::Channel::RequireAllRowsOpen<GDDR6>;
+      // Channel prerequisites; AiM inter-bankgroup 4-bank
+      m_preqs[m_levels["channel"]][m_commands["MAC4B_INTER"]] = Lambdas::Preq::Rank::RequireSameBankRowsOpen<GDDR6>;
+      m_preqs[m_levels["channel"]][m_commands["AF4B_INTER"]]  = Lambdas::Preq::Rank::RequireSameBankRowsOpen<GDDR6>;
 
       // Bankgroup actions; AiM 4-bank
       m_preqs[m_levels["bankgroup"]][m_commands["MAC4B_INTRA"]] = Lambdas::Preq::BankGroup::RequireAllRowsOpen<GDDR6>;
@@ -757,15 +800,16 @@ class GDDR6 : public IDRAM, public Implementation {
       m_preqs[m_levels["bank"]][m_commands["AFSB"]]  = Lambdas::Preq::Bank::RequireRowOpen<GDDR6>;
       m_preqs[m_levels["bank"]][m_commands["RDCP"]]  = Lambdas::Preq::Bank::RequireRowOpen<GDDR6>;
       m_preqs[m_levels["bank"]][m_commands["WRCP"]]  = Lambdas::Preq::Bank::RequireRowOpen<GDDR6>;
-      
-      // can RequireSameBanksClosed be used, or is RequireBankClosed needed?
-      //m_preqs[m_levels["channel"]][m_commands["REFpb"]] = Lambdas::Preq::Bank::RequireAllBanksClosed<GDDR6>;
+
+      // Bank actions; per-bank refresh (the refreshed bank must be precharged)
+      m_preqs[m_levels["bank"]][m_commands["REFpb"]] = Lambdas::Preq::Bank::RequireBankClosed<GDDR6>;
+      // REFp2b is not modelled; it also refreshes the paired bank, and a prerequisite only sees a single address, so it cannot precharge the pair first
       //m_preqs[m_levels["channel"]][m_commands["REFp2b"]] = Lambdas::Preq::Bank::RequireAllBanksClosed<GDDR6>; 
 
     };
 
     void set_rowhits() {
-      m_rowhits.resize(m_levels.size(), std::vector<RowhitFunc_t<Node>>(m_commands.size()));
+      m_rowhits.resize(m_levels.size(), m_commands.size());
 
       // ramulator2
       m_rowhits[m_levels["bank"]][m_commands["RD"]] = Lambdas::RowHit::Bank::RDWR<GDDR6>;
@@ -791,7 +835,7 @@ class GDDR6 : public IDRAM, public Implementation {
     }
 
     void set_rowopens() {
-      m_rowopens.resize(m_levels.size(), std::vector<RowhitFunc_t<Node>>(m_commands.size()));
+      m_rowopens.resize(m_levels.size(), m_commands.size());
 
       // ramulator 2
       m_rowopens[m_levels["bank"]][m_commands["RD"]] = Lambdas::RowOpen::Bank::RDWR<GDDR6>;
@@ -816,12 +860,37 @@ class GDDR6 : public IDRAM, public Implementation {
       m_rowopens[m_levels["bank"]][m_commands["WRCP"]]  = Lambdas::RowOpen::Bank::RDWR<GDDR6>;
     }
 
+    // Bank bit (bankgroup_id * num_banks + bank_id) in m_open_rows, i.e., bankgroup-major like the flat bank index
+    void init_open_row_masks() {
+      int num_bankgroups = m_organization.count[m_levels["bankgroup"]];
+      int num_banks = m_organization.count[m_levels["bank"]];
+      if (num_bankgroups * num_banks > 16) {
+        throw ConfigurationError("{} tracks at most 16 open banks per channel, but the organization has {}!", get_name(), num_bankgroups * num_banks);
+      }
+      m_bankgroup_masks.assign(num_bankgroups, 0);
+      m_same_bank_masks.assign(num_banks, 0);
+      for (int bankgroup_id = 0; bankgroup_id < num_bankgroups; bankgroup_id++) {
+        for (int bank_id = 0; bank_id < num_banks; bank_id++) {
+          uint16_t bank_mask = (uint16_t)(1 << (bankgroup_id * num_banks + bank_id));
+          m_bankgroup_masks[bankgroup_id] |= bank_mask;
+          m_same_bank_masks[bank_id] |= bank_mask;
+          m_all_banks_mask |= bank_mask;
+        }
+      }
+    };
+
     void create_nodes() {
+      m_flat_timing.init(this);
+      m_open_row_ids.init(m_flat_timing);
+      init_open_row_masks();
       int num_channels = m_organization.count[m_levels["channel"]];
       for (int i = 0; i < num_channels; i++) {
         Node* channel = new Node(this, nullptr, 0, i);
         m_channels.push_back(channel);
         m_open_rows.push_back(0);
+        m_future_actions.emplace_back();
+        m_state_versions.push_back(0);
+        m_timing_versions.push_back(0);
       }
     };
 };
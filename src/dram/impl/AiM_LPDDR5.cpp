@@ -57,10 +57,9 @@ class LPDDR5 : public IDRAM, public Implementation {
       // Multi-bank AiM commands
       "ACT4_BG-1", "ACT4_BG-2", "PRE4_BG",
       "MAC4B_INTRA", "AF4B_INTRA", "EWMUL", "EWADD",
-      // TODO: 4-bank commands for inter-bank group
-      // "ACT4_BKS-1", "ACTAF4_BKS-1", "ACT4_BKS-1", "ACTAF4_BKS-1", "PRE4_BKS",
-      // "CASRD4B_INTER", "CASWR4B_INTER",
-      // "MAC4B_INTER", "AF4B_INTER",
+      // 4-bank commands for inter-bank group (the same bank of every bankgroup)
+      "ACT4_BKS-1", "ACT4_BKS-2", "PRE4_BKS",
+      "MAC4B_INTER", "AF4B_INTER",
       "ACT16-1", "ACT16-2",
       "MACAB", "AFAB", "WRAFLUT", "WRBK",
       // No-bank AiM commands
@@ -73,17 +72,15 @@ class LPDDR5 : public IDRAM, public Implementation {
         {"PRE",   "bank"},   {"PREA",   "rank"},
         {"CASRD", "rank"},   {"CASWR",  "rank"},
         {"RD16",  "column"}, {"WR16",   "column"}, {"RD16A", "column"}, {"WR16A", "column"},
-        {"REFab", "rank"},   {"REFpb",  "rank"},   {"REFab_end", "rank"},
+        {"REFab", "rank"},   {"REFpb",  "bank"},   {"REFab_end", "rank"},
         {"RFMab", "rank"},   {"RFMpb",  "rank"},
         // Single-bank AiM commands
         {"MACSB", "column"}, {"AFSB", "column"}, {"RDCP", "column"}, {"WRCP", "column"},
         // Multi-bank AiM commands
         {"ACT4_BG-1", "row"}, {"ACT4_BG-2", "row"}, {"PRE4_BG", "bank"},
         {"MAC4B_INTRA", "column"}, {"AF4B_INTRA", "column"}, {"EWMUL", "column"}, {"EWADD", "column"},
-        // TODO: 4-bank commands for inter-bank group
-        // {"ACT4_BKS-1", "row"}, {"ACTAF4_BKS-1", "row"}, {"ACT4_BKS-2", "row"}, {"ACTAF4_BKS-2", "row"}, {"PRE4_BKS", "bank"},
-        // {"CASRD4B_INTER", "rank"}, {"CASWR4B_INTER",  "rank"},
-        // {"MAC4B_INTER", "column"}, {"AF4B_INTER", "column"},
+        {"ACT4_BKS-1", "row"}, {"ACT4_BKS-2", "row"}, {"PRE4_BKS", "bank"},
+        {"MAC4B_INTER", "column"}, {"AF4B_INTER", "column"},
         {"ACT16-1", "row"},  {"ACT16-2", "row"},
         {"MACAB", "column"}, {"AFAB", "column"}, {"WRAFLUT", "row"},  {"WRBK", "column"},
         // No-bank AiM commands
@@ -98,17 +95,17 @@ class LPDDR5 : public IDRAM, public Implementation {
         {"PRE",   "bank"},   {"PREA",   "rank"},
         {"CASRD", "rank"},   {"CASWR",  "rank"},
         {"RD16",  "column"}, {"WR16",   "column"}, {"RD16A", "column"}, {"WR16A", "column"},
-        {"REFab", "rank"},   {"REFpb",  "rank"},   {"REFab_end", "rank"},
+        {"REFab", "rank"},   {"REFpb",  "bank"},   {"REFab_end", "rank"},
         {"RFMab", "rank"},   {"RFMpb",  "rank"},
         // Single-bank AiM commands
         {"MACSB", "column"}, {"AFSB", "column"}, {"RDCP", "column"}, {"WRCP", "column"},
         // 4-bank commands for intra-bank group
         {"ACT4_BG-1", "bankgroup"}, {"ACT4_BG-2", "bankgroup"}, {"PRE4_BG", "bankgroup"},
         {"MAC4B_INTRA", "bankgroup"}, {"AF4B_INTRA", "bankgroup"}, {"EWMUL", "bankgroup"}, {"EWADD", "bankgroup"},
-        // TODO: 4-bank commands for inter-bank group
-        // {"ACT4_BKS-1", "bank"}, {"ACTAF4_BKS-1", "bank"}, {"ACT4_BKS-2", "bank"}, {"ACTAF4_BKS-2", "bank"}, {"PRE4_BKS", "bank"},
-        // {"CASRD4B_INTER", "rank"}, {"CASWR4B_INTER",  "rank"},
-        // {"MAC4B_INTER", "bank"}, {"AF4B_INTER", "bank"}, {"EWMUL", "bank"}, {"EWADD", "bank"},
+        // 4-bank commands for inter-bank group; same-bank commands (see DRAMCommandMeta::is_sb_cmd)
+        // fanning out to every bankgroup of the rank and to the addressed bank in each of them
+        {"ACT4_BKS-1", "rank"}, {"ACT4_BKS-2", "rank"}, {"PRE4_BKS", "rank"},
+        {"MAC4B_INTER", "rank"}, {"AF4B_INTER", "rank"},
         // all-bank commands
         {"ACT16-1", "rank"}, {"ACT16-2", "rank"},
         {"MACAB", "rank"}, {"AFAB", "rank"}, {"WRAFLUT", "rank"}, {"WRBK", "rank"},
@@ -120,7 +117,7 @@ class LPDDR5 : public IDRAM, public Implementation {
 
     inline static const ImplLUT m_command_meta = LUT<DRAMCommandMeta> (
       m_commands, {
-                // open?   close?   access?  refresh?
+                // open?   close?   access?  refresh?  same-bank?
         {"ACT-1", {false,  false,   false,   false}},
         {"ACT-2", {true,   false,   false,   false}},
         {"PRE",   {false,  true,    false,   false}},
@@ -149,12 +146,11 @@ class LPDDR5 : public IDRAM, public Implementation {
         {"AF4B_INTRA" ,   {false,  false,   true,    false}},
         {"EWMUL",         {false,  false,   true,    false}},
         {"EWADD",         {false,  false,   true,    false}},
-        // TODO: 4-bank commands for inter-bank group
-        // {"ACT4_BKS" ,   {true,  false,    false,   false}},
-        // {"ACTAF4_BKS" ,   {true,  false,    false,   false}},
-        // {"PRE4_BKS" ,   {false,  true,    false,   false}},
-        // {"MAC4B_INTER" ,   {false,  false,    true,   false}},
-        // {"AF4B_INTER" ,   {false,  false,    true,   false}},
+        {"ACT4_BKS-1",    {false,  false,   false,   false,   true}},
+        {"ACT4_BKS-2",    {true,   false,   false,   false,   true}},
+        {"PRE4_BKS",      {false,  true,    false,   false,   true}},
+        {"MAC4B_INTER",   {false,  false,   true,    false,   true}},
+        {"AF4B_INTER",    {false,  false,   true,    false,   true}},
         {"ACT16-1",   {false,   false,   false,   false}},
         {"ACT16-2",   {true,   false,   false,   false}},
         {"MACAB",   {false,  false,   true,    false}},
@@ -189,11 +185,11 @@ class LPDDR5 : public IDRAM, public Implementation {
       "MAC_SBK", "AF_SBK", "COPY_BKGB", "COPY_GBBK",
       // Multi-bank AiM commands
       "MAC_4BK_INTRA_BG", "AF_4BK_INTRA_BG", "EWMUL", "EWADD",
-      // TODO: 4-bank commands for inter-bank group
-      // "MAC_4BK_INTER_BG", "AF_4BK_INTER_BG",
       "MAC_ABK", "AF_ABK", "WR_AFLUT", "WR_BK",
       // AiM DMA commands
       "WR_GB", "WR_MAC", "WR_BIAS", "RD_MAC", "RD_AF",
+      // 4-bank commands for inter-bank group (follow the order of Request::Type)
+      "MAC_4BK_INTER_BG", "AF_4BK_INTER_BG",
     };
 
     inline static const ImplLUT m_aim_req_translation = LUT (
@@ -202,11 +198,11 @@ class LPDDR5 : public IDRAM, public Implementation {
         {"MAC_SBK", "MACSB"}, {"AF_SBK", "AFSB"}, {"COPY_BKGB", "RDCP"}, {"COPY_GBBK", "WRCP"},
         // Multi-bank AiM commands
         {"MAC_4BK_INTRA_BG", "MAC4B_INTRA"}, {"AF_4BK_INTRA_BG", "AF4B_INTRA"}, {"EWMUL", "EWMUL"}, {"EWADD", "EWADD"}, 
-        // TODO: 4-bank commands for inter-bank group
-        // {"MAC_4BK_INTER_BG", "MAC4B_INTER"}, {"AF_4BK_INTER_BG", "AF4B_INTER"}, 
         {"MAC_ABK", "MACAB"}, {"AF_ABK", "AFAB"}, {"WR_AFLUT", "WRAFLUT"}, {"WR_BK", "WRBK"},
         // AiM DMA commands
         {"WR_GB", "WRGB"}, {"WR_MAC", "WRMAC"}, {"WR_BIAS", "WRBIAS"}, {"RD_MAC", "RDMAC"}, {"RD_AF", "RDAF"},
+        // 4-bank commands for inter-bank group
+        {"MAC_4BK_INTER_BG", "MAC4B_INTER"}, {"AF_4BK_INTER_BG", "AF4B_INTER"},
       }
     );
    
@@ -256,6 +252,17 @@ class LPDDR5 : public IDRAM, public Implementation {
       Node(LPDDR5* dram, Node* parent, int level, int id) : DRAMNodeBase<LPDDR5>(dram, parent, level, id) {};
     };
     std::vector<Node*> m_channels;
+    DRAMFlatTiming m_flat_timing;
+    DRAMOpenRows m_open_row_ids;
+    // Bumped whenever a command or a future action updates the node states/timing of a channel
+    std::vector<int64_t> m_state_versions;
+    std::vector<int64_t> m_timing_versions;
+    // Masks of the m_open_rows bits (one per bank of a channel, bankgroup-major)
+    uint16_t m_all_banks_mask = 0;
+    std::vector<uint16_t> m_bankgroup_masks;   // All banks of a bankgroup
+    std::vector<uint16_t> m_same_bank_masks;   // The same bank of every bankgroup
+    // The cycle at which the state version of a channel has to be bumped because of the CAS sync window
+    std::vector<Clk_t> m_state_deadlines;
     
     FuncMatrix<ActionFunc_t<Node>>  m_actions;
     FuncMatrix<PreqFunc_t<Node>>    m_preqs;
@@ -267,22 +274,23 @@ class LPDDR5 : public IDRAM, public Implementation {
       m_clk++;
 
       // Process future actions (e.g., REFab_end after nRFCab cycles)
-      for (int i = m_future_actions.size() - 1; i >= 0; i--) {
-        auto& future_action = m_future_actions[i];
-        if (future_action.clk == m_clk) {
+      FutureAction future_action;
+      for (auto& channel_future_actions : m_future_actions) {
+        while (channel_future_actions.pop_due(m_clk, future_action)) {
           int channel_id = future_action.addr_h[m_levels["channel"]];
           int rank_id = future_action.addr_h[m_levels["rank"]];
 
           DEBUG_LOG(LPDDR5, m_logger,
                     "[AiMulator: LPDDR5 tick()] EXECUTING future action: cmd={}, channel={}, rank={}, cycle={}",
-                    m_commands(future_action), channel_id, rank_id, m_clk);
+                    m_commands(future_action.cmd), channel_id, rank_id, m_clk);
+
+          if (m_channels[channel_id]->update_states(future_action.cmd, future_action.addr_h, m_clk)) {
+            bump_state_version(channel_id);
+          }
 
-          m_channels[channel_id]->update_states(future_action.cmd, future_action.addr_h, m_clk);
-          m_future_actions.erase(m_future_actions.begin() + i);
-          
           DEBUG_LOG(LPDDR5, m_logger,
                     "[AiMulator: LPDDR5 tick()] Future action executed and removed. Remaining: {}",
-                    m_future_actions.size());
+                    channel_future_actions.size());
         }
       }
     };
@@ -311,7 +319,10 @@ class LPDDR5 : public IDRAM, public Implementation {
     void issue_command(int command, const AddrHierarchy_t& addr_h) override {
       int channel_id = addr_h[m_levels["channel"]];
       m_channels[channel_id]->update_timing(command, addr_h, m_clk);
-      m_channels[channel_id]->update_states(command, addr_h, m_clk);
+      m_timing_versions[channel_id]++;
+      if (m_channels[channel_id]->update_states(command, addr_h, m_clk)) {
+        bump_state_version(channel_id);
+      }
       int bankgroup_id = addr_h[m_levels["bankgroup"]];
       int bank_id = addr_h[m_levels["bank"]];
       switch (command)
@@ -321,29 +332,33 @@ class LPDDR5 : public IDRAM, public Implementation {
         break;
       }
       case m_commands["PRE4_BG"]: {
-        for (int bank_id_in_bg = bankgroup_id * 4; bank_id_in_bg < (bankgroup_id + 1) * 4; bank_id_in_bg++) {
-          m_open_rows[channel_id] &= ~((uint16_t)(1 << bank_id_in_bg));
-        }
+        m_open_rows[channel_id] &= ~m_bankgroup_masks[bankgroup_id];
+        break;
+      }
+      case m_commands["PRE4_BKS"]: {
+        m_open_rows[channel_id] &= ~m_same_bank_masks[bank_id];
         break;
       }
       case m_commands["PRE"]:
       case m_commands["RD16A"]:
       case m_commands["WR16A"]: {
-        m_open_rows[channel_id] &= ~((uint16_t)(1 << bank_id));
+        m_open_rows[channel_id] &= ~(m_bankgroup_masks[bankgroup_id] & m_same_bank_masks[bank_id]);
         break;
       }
       case m_commands["ACT16-2"]: {
-        m_open_rows[channel_id] = (uint16_t)(0xFFFF);
+        m_open_rows[channel_id] = m_all_banks_mask;
         break;
       }
       case m_commands["ACT4_BG-2"]: {
-        for (int bank_id_in_bg = bankgroup_id * 4; bank_id_in_bg < (bankgroup_id + 1) * 4; bank_id_in_bg++) {
-          m_open_rows[channel_id] |= ((uint16_t)(1 << bank_id_in_bg));
-        }
+        m_open_rows[channel_id] |= m_bankgroup_masks[bankgroup_id];
+        break;
+      }
+      case m_commands["ACT4_BKS-2"]: {
+        m_open_rows[channel_id] |= m_same_bank_masks[bank_id];
         break;
       }
       case m_commands["ACT-2"]: {
-        m_open_rows[channel_id] |= (uint16_t)(1 << bank_id);
+        m_open_rows[channel_id] |= m_bankgroup_masks[bankgroup_id] & m_same_bank_masks[bank_id];
         break;
       }
       case m_commands["REFab"]: {
@@ -354,11 +369,11 @@ class LPDDR5 : public IDRAM, public Implementation {
                   "[AiMulator: LPDDR5 issue_command()] REFab issued at cycle={}. Scheduling REFab_end for cycle={}, (nRFCab={}), channel={}, rank={}",
                   m_clk, refab_end_cycle, m_timing_vals("nRFCab"), addr_h[m_levels["channel"]], addr_h[m_levels["rank"]]);
         
-        m_future_actions.push_back({m_commands["REFab_end"], addr_h, m_clk + m_timing_vals("nRFCab") - 1});
+        m_future_actions[channel_id].push({m_commands["REFab_end"], addr_h, m_clk + m_timing_vals("nRFCab") - 1});
 
         DEBUG_LOG(LPDDR5, m_logger,
                   "[AiMulator: LPDDR5 issue_command()] Future actions count after REFab: {}",
-                  m_future_actions.size());
+                  m_future_actions[channel_id].size());
         break;
       }
       default:
@@ -386,7 +401,47 @@ class LPDDR5 : public IDRAM, public Implementation {
       return m_channels[channel_id]->check_node_open(command, addr_h, m_clk);
     };
 
+    Clk_t get_next_ready_clk(int channel_id) override {
+      Node* channel = m_channels[channel_id];
+      Clk_t next_ready_clk = channel->get_next_ready_clk(m_clk);
+      // The CAS sync prerequisite changes once the synced window of a rank has passed
+      for (auto rank : channel->m_child_nodes) {
+        if (rank->m_final_synced_cycle + 1 > m_clk) {
+          next_ready_clk = std::min(next_ready_clk, rank->m_final_synced_cycle + 1);
+        }
+      }
+      return next_ready_clk;
+    };
+
+    Clk_t get_ready_clk(int command, const AddrHierarchy_t& addr_h) override {
+      int channel_id = addr_h[m_levels["channel"]];
+      return m_channels[channel_id]->get_ready_clk(command, addr_h);
+    };
+
+    int64_t get_timing_version(int channel_id) override {
+      return m_timing_versions[channel_id];
+    };
+
+    int64_t get_state_version(int channel_id) override {
+      // The CAS sync prerequisite changes once the synced window of a rank has passed
+      if (m_clk >= m_state_deadlines[channel_id]) {
+        bump_state_version(channel_id);
+      }
+      return m_state_versions[channel_id];
+    };
+
   private:
+    void bump_state_version(int channel_id) {
+      m_state_versions[channel_id]++;
+      Clk_t deadline = std::numeric_limits<Clk_t>::max();
+      for (auto rank : m_channels[channel_id]->m_child_nodes) {
+        if (rank->m_final_synced_cycle + 1 > m_clk) {
+          deadline = std::min(deadline, rank->m_final_synced_cycle + 1);
+        }
+      }
+      m_state_deadlines[channel_id] = deadline;
+    };
+
     void set_organization() {
       // Channel width
       // For AiM, the channel_width defaults to 16 (refer to the org_presets)
@@ -554,6 +609,8 @@ class LPDDR5 : public IDRAM, public Implementation {
       m_command_latencies("WRCP")  = 1;
       m_command_latencies("MAC4B_INTRA") = 1;
       m_command_latencies("AF4B_INTRA")  = 1;
+      m_command_latencies("MAC4B_INTER") = 1;
+      m_command_latencies("AF4B_INTER")  = 1;
       m_command_latencies("MACAB") = 1;
       m_command_latencies("AFAB")  = 1;
       m_command_latencies("EWMUL") = 1;
@@ -581,7 +638,7 @@ class LPDDR5 : public IDRAM, public Implementation {
          * CAS <-> CAS
          * Data bus (DQ) occupancy
          *************************************************************/
-        {.level = "channel", .preceding = {"RD16", "RD16A", "MAC4B_INTRA", "AF4B_INTRA", "EWMUL", "EWADD", "MACAB", "AFAB"}, .following = {"RD16", "RD16A", "MAC4B_INTRA", "AF4B_INTRA", "EWMUL", "EWADD", "MACAB", "AFAB"}, .latency = V("nBL16")},
+        {.level = "channel", .preceding = {"RD16", "RD16A", "MAC4B_INTRA", "AF4B_INTRA", "MAC4B_INTER", "AF4B_INTER", "EWMUL", "EWADD", "MACAB", "AFAB"}, .following = {"RD16", "RD16A", "MAC4B_INTRA", "AF4B_INTRA", "MAC4B_INTER", "AF4B_INTER", "EWMUL", "EWADD", "MACAB", "AFAB"}, .latency = V("nBL16")},
         {.level = "channel", .preceding = {"WR16", "WR16A", "WRAFLUT", "WRBK"}, .following = {"WR16", "WR16A", "WRAFLUT", "WRBK"}, .latency = V("nBL16")},
         /***************************************************************************************************
          *                                     DIFFERENT BankGroup (Rank)
@@ -591,50 +648,52 @@ class LPDDR5 : public IDRAM, public Implementation {
          *************************************************************/
         // ACT <-> ACT
         {.level = "rank", .preceding = {"ACT16-1"}, .following = {"ACT16-1"}, .latency = V("nRRD")},
-        {.level = "rank", .preceding = {"ACT4_BG-1"}, .following = {"ACT-1", "ACT4_BG-1"}, .latency = V("nRRD")},
-        {.level = "rank", .preceding = {"ACT-1"}, .following = {"ACT-1", "ACT4_BG-1"}, .latency = V("nRRD")},
+        {.level = "rank", .preceding = {"ACT4_BG-1", "ACT4_BKS-1"}, .following = {"ACT-1", "ACT4_BG-1", "ACT4_BKS-1"}, .latency = V("nRRD")},
+        {.level = "rank", .preceding = {"ACT-1"}, .following = {"ACT-1", "ACT4_BG-1", "ACT4_BKS-1"}, .latency = V("nRRD")},
         {.level = "rank", .preceding = {"ACT-1"}, .following = {"ACT-1"}, .latency = V("nFAW"), .window = 4},
         // ACT <-> PRE
-        {.level = "rank", .preceding = {"ACT-1", "ACT4_BG-1", "ACT16-1"}, .following = {"PREA"}, .latency = V("nRAS")},
-        {.level = "rank", .preceding = {"PREA"},  .following = {"ACT-1", "ACT4_BG-1", "ACT16-1"}, .latency = V("nRPab")},
-        {.level = "rank", .preceding = {"PRE4_BG"}, .following = {"ACT16-1"}, .latency = V("nRPab")},
+        {.level = "rank", .preceding = {"ACT-1", "ACT4_BG-1", "ACT4_BKS-1", "ACT16-1"}, .following = {"PREA"}, .latency = V("nRAS")},
+        {.level = "rank", .preceding = {"PREA"},  .following = {"ACT-1", "ACT4_BG-1", "ACT4_BKS-1", "ACT16-1"}, .latency = V("nRPab")},
+        {.level = "rank", .preceding = {"PRE4_BG", "PRE4_BKS"}, .following = {"ACT16-1"}, .latency = V("nRPab")},
         {.level = "rank", .preceding = {"PRE"}, .following = {"ACT16-1"}, .latency = V("nRPpb")},
         /************************************************************
          * CAS <-> RAS
          *************************************************************/
-        {.level = "rank", .preceding = {"ACT-1", "ACT4_BG-1", "ACT16-1"}, .following = {"MACAB", "AFAB", "WRAFLUT", "WRBK"}, .latency = V("nRCD")},
-        {.level = "rank", .preceding = {"RD16", "RD16A", "MAC4B_INTRA", "AF4B_INTRA", "EWMUL", "EWADD", "MACAB", "AFAB"}, .following = {"PREA"}, .latency = V("nRTP")},
+        {.level = "rank", .preceding = {"ACT-1", "ACT4_BG-1", "ACT4_BKS-1", "ACT16-1"}, .following = {"MACAB", "AFAB", "WRAFLUT", "WRBK"}, .latency = V("nRCD")},
+        {.level = "rank", .preceding = {"RD16", "RD16A", "MAC4B_INTRA", "AF4B_INTRA", "MAC4B_INTER", "AF4B_INTER", "EWMUL", "EWADD", "MACAB", "AFAB"}, .following = {"PREA"}, .latency = V("nRTP")},
         {.level = "rank", .preceding = {"WR16", "WR16A", "WRAFLUT", "WRBK"}, .following = {"PREA"}, .latency = V("nCWL")+V("nBL16")+V("nWR")},
         /************************************************************
          * CAS <-> CAS
          *************************************************************/
         // RD -> RD, WR -> WR
-        {.level = "rank", .preceding = {"RD16", "RD16A", "MAC4B_INTRA", "AF4B_INTRA", "EWMUL", "EWADD", "MACAB", "AFAB"}, .following = {"RD16", "RD16A", "MAC4B_INTRA", "AF4B_INTRA", "EWMUL", "EWADD", "MACAB", "AFAB"}, .latency = V("nCCD")},
+        {.level = "rank", .preceding = {"RD16", "RD16A", "MAC4B_INTRA", "AF4B_INTRA", "MAC4B_INTER", "AF4B_INTER", "EWMUL", "EWADD", "MACAB", "AFAB"}, .following = {"RD16", "RD16A", "MAC4B_INTRA", "AF4B_INTRA", "MAC4B_INTER", "AF4B_INTER", "EWMUL", "EWADD", "MACAB", "AFAB"}, .latency = V("nCCD")},
         {.level = "rank", .preceding = {"WR16", "WR16A", "WRAFLUT", "WRBK"}, .following = {"WR16", "WR16A", "WRAFLUT", "WRBK"}, .latency = V("nCCD")},
         // RD -> WR; Minimum Read to Write, Assuming tWPRE = 1 tCK                          
-        {.level = "rank", .preceding = {"RD16", "RD16A", "MAC4B_INTRA", "AF4B_INTRA", "EWMUL", "EWADD", "MACAB", "AFAB"}, .following = {"WR16", "WR16A", "WRAFLUT", "WRBK"}, .latency = V("nCL")+V("nBL16")+2-V("nCWL")},      
+        {.level = "rank", .preceding = {"RD16", "RD16A", "MAC4B_INTRA", "AF4B_INTRA", "MAC4B_INTER", "AF4B_INTER", "EWMUL", "EWADD", "MACAB", "AFAB"}, .following = {"WR16", "WR16A", "WRAFLUT", "WRBK"}, .latency = V("nCL")+V("nBL16")+2-V("nCWL")},      
         // WR -> RD; Minimum Read after Write
-        {.level = "rank", .preceding = {"WR16", "WR16A", "WRAFLUT", "WRBK"}, .following = {"RD16", "RD16A", "MAC4B_INTRA", "AF4B_INTRA", "EWMUL", "EWADD", "MACAB", "AFAB"}, .latency = V("nCWL")+V("nBL16")+V("nWTRS")},
+        {.level = "rank", .preceding = {"WR16", "WR16A", "WRAFLUT", "WRBK"}, .following = {"RD16", "RD16A", "MAC4B_INTRA", "AF4B_INTRA", "MAC4B_INTER", "AF4B_INTER", "EWMUL", "EWADD", "MACAB", "AFAB"}, .latency = V("nCWL")+V("nBL16")+V("nWTRS")},
         /************************************************************
          * CAS <-> CAS between sibling ranks, nCS (rank switching) is needed for new DQS
          *************************************************************/
         // RD -> RD/WR
-        {.level = "rank", .preceding = {"RD16", "RD16A", "MAC4B_INTRA", "AF4B_INTRA", "EWMUL", "EWADD", "MACAB", "AFAB"}, .following = {"RD16", "RD16A", "MAC4B_INTRA", "AF4B_INTRA", "EWMUL", "EWADD", "MACAB", "AFAB", "WR16", "WR16A", "WRAFLUT", "WRBK"}, .latency = V("nBL16")+V("nCS"), .is_sibling = true},
+        {.level = "rank", .preceding = {"RD16", "RD16A", "MAC4B_INTRA", "AF4B_INTRA", "MAC4B_INTER", "AF4B_INTER", "EWMUL", "EWADD", "MACAB", "AFAB"}, .following = {"RD16", "RD16A", "MAC4B_INTRA", "AF4B_INTRA", "MAC4B_INTER", "AF4B_INTER", "EWMUL", "EWADD", "MACAB", "AFAB", "WR16", "WR16A", "WRAFLUT", "WRBK"}, .latency = V("nBL16")+V("nCS"), .is_sibling = true},
         // WR -> RD
-        {.level = "rank", .preceding = {"WR16", "WR16A", "WRAFLUT", "WRBK"}, .following = {"RD16", "RD16A", "MAC4B_INTRA", "AF4B_INTRA", "EWMUL", "EWADD", "MACAB", "AFAB"}, .latency = V("nCL")+V("nBL16")+V("nCS")-V("nCWL"), .is_sibling = true},
+        {.level = "rank", .preceding = {"WR16", "WR16A", "WRAFLUT", "WRBK"}, .following = {"RD16", "RD16A", "MAC4B_INTRA", "AF4B_INTRA", "MAC4B_INTER", "AF4B_INTER", "EWMUL", "EWADD", "MACAB", "AFAB"}, .latency = V("nCL")+V("nBL16")+V("nCS")-V("nCWL"), .is_sibling = true},
         // WR -> WR
         {.level = "rank", .preceding = {"WR16", "WR16A", "WRAFLUT", "WRBK"}, .following = {"WR16", "WR16A", "WRAFLUT", "WRBK"}, .latency = V("nBL16")+V("nCS"), .is_sibling = true},
         /************************************************************ 
          * REF
          *************************************************************/
         /// RAS <-> REF
-        {.level = "rank", .preceding = {"ACT-1", "ACT4_BG-1", "ACT4_BG-2", "ACT16-1", "ACT16-2"}, .following = {"REFab"}, .latency = V("nRC")},
-        {.level = "rank", .preceding = {"PRE", "PRE4_BG"},   .following = {"REFab"}, .latency = V("nRPpb")},
+        {.level = "rank", .preceding = {"ACT-1", "ACT4_BG-1", "ACT4_BKS-1", "ACT4_BG-2", "ACT4_BKS-2", "ACT16-1", "ACT16-2"}, .following = {"REFab"}, .latency = V("nRC")},
+        {.level = "rank", .preceding = {"PRE", "PRE4_BG", "PRE4_BKS"},   .following = {"REFab"}, .latency = V("nRPpb")},
         {.level = "rank", .preceding = {"PREA"},  .following = {"REFab"}, .latency = V("nRPab")},
         {.level = "rank", .preceding = {"RD16A"}, .following = {"REFab"}, .latency = V("nRPpb")+V("nRTP")},
         {.level = "rank", .preceding = {"WR16A"}, .following = {"REFab"}, .latency = V("nCWL")+V("nBL16")+V("nWR")+V("nRPpb")},
-        {.level = "rank", .preceding = {"REFab"}, .following = {"REFab", "ACT-1", "ACT4_BG-1", "ACT4_BG-2", "ACT16-1", "ACT16-2", "PRE", "PRE4_BG", "PREA", "REFpb"}, .latency = V("nRFCab")},
-        {.level = "rank", .preceding = {"ACT-1"}, .following = {"REFpb"}, .latency = V("nPBR2ACT")},
+        {.level = "rank", .preceding = {"REFab"}, .following = {"REFab", "ACT-1", "ACT4_BG-1", "ACT4_BKS-1", "ACT4_BG-2", "ACT4_BKS-2", "ACT16-1", "ACT16-2", "PRE", "PRE4_BG", "PRE4_BKS", "PREA", "REFpb"}, .latency = V("nRFCab")},
+        {.level = "rank", .preceding = {"PREA"},  .following = {"REFpb"}, .latency = V("nRPab")},
+        {.level = "rank", .preceding = {"REFpb"}, .following = {"REFab"}, .latency = V("nRFCpb")},
+        {.level = "rank", .preceding = {"REFpb"}, .following = {"ACT-1", "ACT4_BG-1", "ACT4_BKS-1", "ACT16-1"}, .latency = V("nPBR2ACT")},
         {.level = "rank", .preceding = {"REFpb"}, .following = {"REFpb"}, .latency = V("nPBR2PBR")},
         /***************************************************************************************************
          *                                     SAME BankGroup (Rank)
@@ -643,48 +702,56 @@ class LPDDR5 : public IDRAM, public Implementation {
          * RAS <-> RAS
          *************************************************************/
         {.level = "bankgroup", .preceding = {"ACT-1"}, .following = {"ACT-1"}, .latency = V("nRRD")},
-        {.level = "bankgroup", .preceding = {"ACT-1", "ACT4_BG-1", "ACT16-1"}, .following = {"PRE4_BG"}, .latency = V("nRAS")},
-        {.level = "bankgroup", .preceding = {"PRE4_BG"}, .following = {"ACT-1", "ACT4_BG-1"}, .latency = V("nRPab")},
-        {.level = "bankgroup", .preceding = {"PRE"}, .following = {"ACT4_BG-1"}, .latency = V("nRPpb")},
+        {.level = "bankgroup", .preceding = {"ACT-1", "ACT4_BG-1", "ACT4_BKS-1", "ACT16-1"}, .following = {"PRE4_BG", "PRE4_BKS"}, .latency = V("nRAS")},
+        {.level = "bankgroup", .preceding = {"PRE4_BG", "PRE4_BKS"}, .following = {"ACT-1", "ACT4_BG-1", "ACT4_BKS-1"}, .latency = V("nRPab")},
+        {.level = "bankgroup", .preceding = {"PRE"}, .following = {"ACT4_BG-1", "ACT4_BKS-1"}, .latency = V("nRPpb")},
         /************************************************************
          * CAS <-> RAS
          *************************************************************/
-        {.level = "bankgroup", .preceding = {"ACT4_BG-1", "ACT16-1"}, .following = {"MAC4B_INTRA", "AF4B_INTRA", "EWMUL", "EWADD"}, .latency = V("nRCD")},
-        {.level = "bankgroup", .preceding = {"RD16", "RD16A", "MAC4B_INTRA", "AF4B_INTRA", "EWMUL", "EWADD", "MACAB", "AFAB"}, .following = {"PRE4_BG"}, .latency = V("nRTP")},
-        {.level = "bankgroup", .preceding = {"WRAFLUT", "WRBK"}, .following = {"PRE4_BG"}, .latency = V("nCWL")+V("nBL16")+V("nWR")},
+        {.level = "bankgroup", .preceding = {"ACT4_BG-1", "ACT4_BKS-1", "ACT16-1"}, .following = {"MAC4B_INTRA", "AF4B_INTRA", "MAC4B_INTER", "AF4B_INTER", "EWMUL", "EWADD"}, .latency = V("nRCD")},
+        {.level = "bankgroup", .preceding = {"RD16", "RD16A", "MAC4B_INTRA", "AF4B_INTRA", "MAC4B_INTER", "AF4B_INTER", "EWMUL", "EWADD", "MACAB", "AFAB"}, .following = {"PRE4_BG", "PRE4_BKS"}, .latency = V("nRTP")},
+        {.level = "bankgroup", .preceding = {"WRAFLUT", "WRBK"}, .following = {"PRE4_BG", "PRE4_BKS"}, .latency = V("nCWL")+V("nBL16")+V("nWR")},
         /************************************************************
          * CAS <-> CAS
          *************************************************************/
         {.level = "bankgroup", .preceding = {"RD16", "RD16A"}, .following = {"RD16", "RD16A"}, .latency = V("nCCD")},
         {.level = "bankgroup", .preceding = {"WR16", "WR16A"}, .following = {"WR16", "WR16A"}, .latency = V("nCCD")},
-        {.level = "bankgroup", .preceding = {"WR16", "WR16A"}, .following = {"RD16", "RD16A", "MAC4B_INTRA", "AF4B_INTRA", "EWMUL", "EWADD"}, .latency = V("nCWL")+V("nBL16")+V("nWTRL")},
+        {.level = "bankgroup", .preceding = {"WR16", "WR16A"}, .following = {"RD16", "RD16A", "MAC4B_INTRA", "AF4B_INTRA", "MAC4B_INTER", "AF4B_INTER", "EWMUL", "EWADD"}, .latency = V("nCWL")+V("nBL16")+V("nWTRL")},
         /***************************************************************************************************
          *                                             Bank
          ***************************************************************************************************/
         /************************************************************
          * RAS <-> RAS
          *************************************************************/
-        {.level = "bank", .preceding = {"ACT-1"}, .following = {"ACT-1"}, .latency = V("nRC")},
-        {.level = "bank", .preceding = {"ACT-1", "ACT4_BG-1", "ACT16-1"}, .following = {"PRE"}, .latency = V("nRAS")},
-        {.level = "bank", .preceding = {"PRE"},   .following = {"ACT-1"}, .latency = V("nRPpb")},
+        // ACT4_BKS/PRE4_BKS (inter-bankgroup 4-bank) update the addressed bank of every bankgroup
+        {.level = "bank", .preceding = {"ACT-1", "ACT4_BKS-1"}, .following = {"ACT-1", "ACT4_BKS-1"}, .latency = V("nRC")},
+        {.level = "bank", .preceding = {"ACT-1", "ACT4_BG-1", "ACT4_BKS-1", "ACT16-1"}, .following = {"PRE", "PRE4_BKS"}, .latency = V("nRAS")},
+        {.level = "bank", .preceding = {"PRE", "PRE4_BKS"},   .following = {"ACT-1", "ACT4_BKS-1"}, .latency = V("nRPpb")},
         /************************************************************
          * CAS <-> RAS
          *************************************************************/
-        {.level = "bank", .preceding = {"ACT-1", "ACT4_BG-1", "ACT16-1"}, .following = {"RD16", "RD16A", "WR16", "WR16A"}, .latency = V("nRCD")},
-        {.level = "bank", .preceding = {"RD16", "MAC4B_INTRA", "AF4B_INTRA", "EWMUL", "EWADD", "MACAB", "AFAB"}, .following = {"PRE"}, .latency = V("nRTP")},
-        {.level = "bank", .preceding = {"WR16", "WRAFLUT", "WRBK"},  .following = {"PRE"}, .latency = V("nCWL")+V("nBL16")+V("nWR")},
-        {.level = "bank", .preceding = {"RD16A"}, .following = {"ACT-1"}, .latency = V("nRTP")+V("nRPpb")},
-        {.level = "bank", .preceding = {"WR16A"}, .following = {"ACT-1"}, .latency = V("nCWL")+V("nBL16")+V("nWR")+V("nRPpb")},
+        {.level = "bank", .preceding = {"ACT-1", "ACT4_BG-1", "ACT4_BKS-1", "ACT16-1"}, .following = {"RD16", "RD16A", "WR16", "WR16A", "MAC4B_INTER", "AF4B_INTER"}, .latency = V("nRCD")},
+        {.level = "bank", .preceding = {"RD16", "MAC4B_INTRA", "AF4B_INTRA", "MAC4B_INTER", "AF4B_INTER", "EWMUL", "EWADD", "MACAB", "AFAB"}, .following = {"PRE", "PRE4_BKS"}, .latency = V("nRTP")},
+        {.level = "bank", .preceding = {"WR16", "WRAFLUT", "WRBK"},  .following = {"PRE", "PRE4_BKS"}, .latency = V("nCWL")+V("nBL16")+V("nWR")},
+        {.level = "bank", .preceding = {"RD16A"}, .following = {"ACT-1", "ACT4_BKS-1"}, .latency = V("nRTP")+V("nRPpb")},
+        {.level = "bank", .preceding = {"WR16A"}, .following = {"ACT-1", "ACT4_BKS-1"}, .latency = V("nCWL")+V("nBL16")+V("nWR")+V("nRPpb")},
+        /************************************************************
+         * RAS <-> REFpb (the refreshed bank)
+         *************************************************************/
+        {.level = "bank", .preceding = {"PRE", "PRE4_BG", "PRE4_BKS"}, .following = {"REFpb"}, .latency = V("nRPpb")},
+        {.level = "bank", .preceding = {"RD16A"}, .following = {"REFpb"}, .latency = V("nRTP")+V("nRPpb")},
+        {.level = "bank", .preceding = {"WR16A"}, .following = {"REFpb"}, .latency = V("nCWL")+V("nBL16")+V("nWR")+V("nRPpb")},
+        {.level = "bank", .preceding = {"REFpb"}, .following = {"ACT-1", "ACT4_BG-1", "ACT4_BKS-1", "ACT16-1"}, .latency = V("nRFCpb")},
         });
       #undef V
     };
 
     void set_actions() {
-      m_actions.resize(m_levels.size(), std::vector<ActionFunc_t<Node>>(m_commands.size()));
+      m_actions.resize(m_levels.size(), m_commands.size());
 
       #define ACTION_DEF(OP)                                                                                              \
-      m_actions[m_levels["rank"]][m_commands[#OP]] = [this] (Node *node, int cmd, const AddrHierarchy_t& addr_h, Clk_t clk) { \
-        node->m_final_synced_cycle = clk + m_command_latencies(#OP);                                                      \
+      m_actions[m_levels["rank"]][m_commands[#OP]] = [] (Node *node, int cmd, const AddrHierarchy_t& addr_h, Clk_t clk) {    \
+        node->m_final_synced_cycle = clk + node->m_spec->m_command_latencies(m_commands[#OP]);                             \
       };
       
       // m_final_synced_cycle is exactly the execution time for the command.
@@ -710,7 +777,7 @@ class LPDDR5 : public IDRAM, public Implementation {
         for (auto bg : node->m_child_nodes) {
           for (auto bank : bg->m_child_nodes) {
             bank->m_state = m_states["Pre-Opened"];
-            bank->m_row_state[addr_h[m_levels["row"]]] = m_states["Pre-Opened"];
+            bank->set_open_row(addr_h[m_levels["row"]]);
           }
         }
       };
@@ -725,13 +792,26 @@ class LPDDR5 : public IDRAM, public Implementation {
       ACTION_DEF(EWMUL);
       ACTION_DEF(EWADD);
 
+      // Rank actions; AiM inter-bankgroup 4-bank commands (the same bank of every bankgroup)
+      m_actions[m_levels["rank"]][m_commands["ACT4_BKS-1"]] = [] (Node* node, int cmd, const AddrHierarchy_t& addr_h, Clk_t clk) {
+        for (auto bg : node->m_child_nodes) {
+          auto bank = bg->m_child_nodes[addr_h[m_levels["bank"]]];
+          bank->m_state = m_states["Pre-Opened"];
+          bank->set_open_row(addr_h[m_levels["row"]]);
+        }
+      };
+      m_actions[m_levels["rank"]][m_commands["ACT4_BKS-2"]] = Lambdas::Action::Rank::ACT4b_sb<LPDDR5>;
+      m_actions[m_levels["rank"]][m_commands["PRE4_BKS"]]   = Lambdas::Action::Rank::PRE4b_sb<LPDDR5>;
+      ACTION_DEF(MAC4B_INTER);
+      ACTION_DEF(AF4B_INTER);
+
       // Bank group Actions; AiM
       // Action for ACT_BG-1: Transition all banks in the group to "Pre-Opened".
-      m_actions[m_levels["bankgroup"]][m_commands["ACT4_BG-1"]] = [this] (Node* node, int cmd, const AddrHierarchy_t& addr_h, Clk_t clk) {
+      m_actions[m_levels["bankgroup"]][m_commands["ACT4_BG-1"]] = [] (Node* node, int cmd, const AddrHierarchy_t& addr_h, Clk_t clk) {
         int row_id = addr_h[m_levels["row"]];
         for (auto bank : node->m_child_nodes) {
           bank->m_state = m_states["Pre-Opened"];
-          bank->m_row_state[row_id] = m_states["Pre-Opened"];
+          bank->set_open_row(row_id);
         }
       };
       
@@ -743,7 +823,7 @@ class LPDDR5 : public IDRAM, public Implementation {
       m_actions[m_levels["bank"]][m_commands["ACT-1"]] = [] (Node* node, int cmd, const AddrHierarchy_t& addr_h, Clk_t clk) {
         int row_id = addr_h[m_levels["row"]];
         node->m_state = m_states["Pre-Opened"];
-        node->m_row_state[row_id] = m_states["Pre-Opened"];
+        node->set_open_row(row_id);
       };
       m_actions[m_levels["bank"]][m_commands["ACT-2"]] = Lambdas::Action::Bank::ACT<LPDDR5>;
       m_actions[m_levels["bank"]][m_commands["PRE"]]   = Lambdas::Action::Bank::PRE<LPDDR5>;
@@ -752,19 +832,19 @@ class LPDDR5 : public IDRAM, public Implementation {
     };
 
     void set_preqs() {
-      m_preqs.resize(m_levels.size(), std::vector<PreqFunc_t<Node>>(m_commands.size()));
+      m_preqs.resize(m_levels.size(), m_commands.size());
 
       // Rank Preqs
       m_preqs[m_levels["rank"]][m_commands["REFab"]] = Lambdas::Preq::Rank::RequireAllBanksClosed<LPDDR5>;
       m_preqs[m_levels["rank"]][m_commands["RFMab"]] = Lambdas::Preq::Rank::RequireAllBanksClosed<LPDDR5>;
 
-      m_preqs[m_levels["rank"]][m_commands["REFpb"]] = [this] (Node* node, int cmd, const AddrHierarchy_t& addr_h, Clk_t clk) {
+      m_preqs[m_levels["rank"]][m_commands["RFMpb"]] = [] (Node* node, int cmd, const AddrHierarchy_t& addr_h, Clk_t clk) {
         for (auto bg : node->m_child_nodes) {
           for (auto bank : bg->m_child_nodes) {
-            int num_banks_per_bg = m_organization.count[m_levels["bank"]];
+            int num_banks_per_bg = node->m_spec->m_organization.count[m_levels["bank"]];
             int flat_bankid = bank->m_node_id + bg->m_node_id * num_banks_per_bg;
             if (flat_bankid == addr_h[LPDDR5::m_levels["bank"]] || flat_bankid == addr_h[LPDDR5::m_levels["bank"]] + 8) {
-              switch (node->m_state) {
+              switch (bank->m_state) {
                 case m_states["Pre-Opened"]: return m_commands["PRE"];
                 case m_states["Opened"]: return m_commands["PRE"];
               }
@@ -773,8 +853,6 @@ class LPDDR5 : public IDRAM, public Implementation {
         }
         return cmd;
       };
-      
-      m_preqs[m_levels["rank"]][m_commands["RFMpb"]] = m_preqs[m_levels["rank"]][m_commands["REFpb"]];
 
       // Rank Preqs; AiM
       m_preqs[m_levels["rank"]][m_commands["MACAB"]]   = Lambdas::Preq::Rank::RequireAllRowsOpen<LPDDR5>;
@@ -782,8 +860,53 @@ class LPDDR5 : public IDRAM, public Implementation {
       m_preqs[m_levels["rank"]][m_commands["WRAFLUT"]] = Lambdas::Preq::Rank::RequireAllRowsOpen<LPDDR5>;
       m_preqs[m_levels["rank"]][m_commands["WRBK"]]    = Lambdas::Preq::Rank::RequireAllRowsOpen<LPDDR5>;
 
+      // Rank Preqs; AiM inter-bankgroup 4-bank commands (the same bank of every bankgroup)
+      PreqFunc_t<Node> same_bank_preqs = [] (Node* node, int cmd, const AddrHierarchy_t& addr_h, Clk_t clk) -> int {
+        int num_banks = 0;
+        int num_closed_banks = 0;
+        int num_preopen_banks = 0;
+        int num_open_banks = 0;
+
+        for (auto bg : node->m_child_nodes) {
+          auto bank = bg->m_child_nodes[addr_h[LPDDR5::m_levels["bank"]]];
+          num_banks++;
+          switch (bank->m_state) {
+            case m_states["Opened"]:
+              if (bank->is_row_open(addr_h[LPDDR5::m_levels["row"]])) { num_open_banks++; }
+              // CONFLICT; Wrong row is fully open.
+              else { return m_commands["PRE4_BKS"]; }
+              break;
+            case m_states["Pre-Opened"]:
+              if (bank->is_row_open(addr_h[LPDDR5::m_levels["row"]])) { num_preopen_banks++; }
+              // CONFLICT; Wrong row is pre-open.
+              else { return m_commands["PRE4_BKS"]; }
+              break;
+            case m_states["Closed"]:
+              num_closed_banks++;
+              break;
+            case m_states["Refreshing"]:
+              // Same as the intra-bankgroup commands; timing constraints enforce the wait
+              return cmd;
+            default: return m_commands["PRE4_BKS"];
+          }
+        }
+
+        if (num_banks == 0) { return cmd; }
+
+        if (num_open_banks == num_banks) {
+          if (node->m_final_synced_cycle < clk) { return m_commands["CASRD"]; }
+          else { return cmd; }
+        }
+        else if (num_preopen_banks == num_banks) { return m_commands["ACT4_BKS-2"]; }
+        else if (num_closed_banks == num_banks) { return m_commands["ACT4_BKS-1"]; }
+        // Mixed state
+        else { return m_commands["PRE4_BKS"]; }
+      };
+      m_preqs[m_levels["rank"]][m_commands["MAC4B_INTER"]] = same_bank_preqs;
+      m_preqs[m_levels["rank"]][m_commands["AF4B_INTER"]]  = same_bank_preqs;
+
       // BankGroup Preqs
-      auto bankgroup_preqs = [this] (Node* node, int cmd, const AddrHierarchy_t& addr_h, Clk_t clk) -> int {
+      PreqFunc_t<Node> bankgroup_preqs = [] (Node* node, int cmd, const AddrHierarchy_t& addr_h, Clk_t clk) -> int {
         int num_banks_in_bg = 0;
         int num_closed_banks = 0;
         int num_preopen_banks = 0;
@@ -793,7 +916,7 @@ class LPDDR5 : public IDRAM, public Implementation {
           num_banks_in_bg++;
           switch (bank->m_state) {
             case m_states["Opened"]:
-              if (bank->m_row_state.find(addr_h[LPDDR5::m_levels["row"]]) != bank->m_row_state.end()) {
+              if (bank->is_row_open(addr_h[LPDDR5::m_levels["row"]])) {
                 num_open_banks++;
               } else {
                 // CONFLICT; Wrong wro is fully open.
@@ -801,7 +924,7 @@ class LPDDR5 : public IDRAM, public Implementation {
               }
               break;
             case m_states["Pre-Opened"]:
-              if (bank->m_row_state.find(addr_h[LPDDR5::m_levels["row"]]) != bank->m_row_state.end()) {
+              if (bank->is_row_open(addr_h[LPDDR5::m_levels["row"]])) {
                 num_preopen_banks++;
               } else {
                 // CONFLICT; Wrong row is pre-open.
@@ -838,12 +961,12 @@ class LPDDR5 : public IDRAM, public Implementation {
       m_preqs[m_levels["bankgroup"]][m_commands["EWADD"]]       = bankgroup_preqs;
 
       // Bank Preqs
-      auto bank_preqs = [this] (Node* node, int cmd, const AddrHierarchy_t& addr_h, Clk_t clk) -> int {
+      PreqFunc_t<Node> bank_preqs = [] (Node* node, int cmd, const AddrHierarchy_t& addr_h, Clk_t clk) -> int {
         switch (node->m_state) {
           case m_states["Closed"]: return m_commands["ACT-1"];
           case m_states["Pre-Opened"]: return m_commands["ACT-2"];
           case m_states["Opened"]: {
-            if (node->m_row_state.find(addr_h[m_levels["row"]]) != node->m_row_state.end()) {
+            if (node->is_row_open(addr_h[m_levels["row"]])) {
               Node* rank = node->m_parent_node->m_parent_node;
               if (rank->m_final_synced_cycle < clk) {
                 // Determine the appropriate CAS command based on the original command
@@ -865,6 +988,15 @@ class LPDDR5 : public IDRAM, public Implementation {
       };
       m_preqs[m_levels["bank"]][m_commands["RD16"]] = bank_preqs;
       m_preqs[m_levels["bank"]][m_commands["WR16"]] = bank_preqs;
+
+      // The refreshed bank must be precharged (a refreshing bank is waited for by the timing constraints)
+      m_preqs[m_levels["bank"]][m_commands["REFpb"]] = [] (Node* node, int cmd, const AddrHierarchy_t& addr_h, Clk_t clk) -> int {
+        switch (node->m_state) {
+          case m_states["Pre-Opened"]: return m_commands["PRE"];
+          case m_states["Opened"]:     return m_commands["PRE"];
+          default:                     return cmd;
+        }
+      };
       
       // Bank Preqs; AiM
       m_preqs[m_levels["bank"]][m_commands["MACSB"]] = bank_preqs;
@@ -874,7 +1006,7 @@ class LPDDR5 : public IDRAM, public Implementation {
     };
 
     void set_rowhits() {
-      m_rowhits.resize(m_levels.size(), std::vector<RowhitFunc_t<Node>>(m_commands.size()));
+      m_rowhits.resize(m_levels.size(), m_commands.size());
 
       m_rowhits[m_levels["bank"]][m_commands["RD16"]] = Lambdas::RowHit::Bank::RDWR<LPDDR5>;
       m_rowhits[m_levels["bank"]][m_commands["WR16"]] = Lambdas::RowHit::Bank::RDWR<LPDDR5>;
@@ -899,7 +1031,7 @@ class LPDDR5 : public IDRAM, public Implementation {
     }
 
     void set_rowopens() {
-      m_rowopens.resize(m_levels.size(), std::vector<RowhitFunc_t<Node>>(m_commands.size()));
+      m_rowopens.resize(m_levels.size(), m_commands.size());
 
       // AiM all-bank
       m_rowopens[m_levels["channel"]][m_commands["MACAB"]]   = Lambdas::RowOpen::Channel::RDWR16<LPDDR5>;
@@ -920,12 +1052,38 @@ class LPDDR5 : public IDRAM, public Implementation {
       m_rowopens[m_levels["bank"]][m_commands["WRCP"]]  = Lambdas::RowOpen::Bank::RDWR<LPDDR5>;
     }
 
+    // Bank bit (bankgroup_id * num_banks + bank_id) in m_open_rows, i.e., bankgroup-major like the flat bank index
+    void init_open_row_masks() {
+      int num_bankgroups = m_organization.count[m_levels["bankgroup"]];
+      int num_banks = m_organization.count[m_levels["bank"]];
+      if (num_bankgroups * num_banks > 16) {
+        throw ConfigurationError("{} tracks at most 16 open banks per channel, but the organization has {}!", get_name(), num_bankgroups * num_banks);
+      }
+      m_bankgroup_masks.assign(num_bankgroups, 0);
+      m_same_bank_masks.assign(num_banks, 0);
+      for (int bankgroup_id = 0; bankgroup_id < num_bankgroups; bankgroup_id++) {
+        for (int bank_id = 0; bank_id < num_banks; bank_id++) {
+          uint16_t bank_mask = (uint16_t)(1 << (bankgroup_id * num_banks + bank_id));
+          m_bankgroup_masks[bankgroup_id] |= bank_mask;
+          m_same_bank_masks[bank_id] |= bank_mask;
+          m_all_banks_mask |= bank_mask;
+        }
+      }
+    };
+
     void create_nodes() {
+      m_flat_timing.init(this);
+      m_open_row_ids.init(m_flat_timing);
+      init_open_row_masks();
       int num_channels = m_organization.count[m_levels["channel"]];
       for (int i = 0; i < num_channels; i++) {
         Node* channel = new Node(this, nullptr, 0, i);
         m_channels.push_back(channel);
         m_open_rows.push_back(0);
+        m_future_actions.emplace_back();
+        m_state_versions.push_back(0);
+        m_timing_versions.push_back(0);
+        m_state_deadlines.push_back(std::numeric_limits<Clk_t>::max());
       }
     };
 };
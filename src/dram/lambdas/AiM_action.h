@@ -16,13 +16,13 @@ namespace Bank {
   template <class T>
   void ACT(typename T::Node* node, int cmd, const AddrHierarchy_t& addr_h, Clk_t clk) {
     node->m_state = T::m_states["Opened"];
-    node->m_row_state[addr_h[T::m_levels["row"]]] = T::m_states["Opened"];
+    node->set_open_row(addr_h[T::m_levels["row"]]);
   };
 
   template <class T>
   void PRE(typename T::Node* node, int cmd, const AddrHierarchy_t& addr_h, Clk_t clk) {
     node->m_state = T::m_states["Closed"];
-    node->m_row_state.clear();
+    node->clear_open_row();
   };
 
   template <class T>
@@ -42,7 +42,7 @@ namespace BankGroup {
     for (auto bank : node->m_child_nodes) {
       if (bank->m_node_id == addr_h[T::m_levels["bank"]]) {
         bank->m_state = T::m_states["Closed"];
-        bank->m_row_state.clear();
+        bank->clear_open_row();
       }
     }
   };
@@ -61,7 +61,7 @@ namespace BankGroup {
     for (auto bank : node->m_child_nodes) {
       if (bank->m_node_id == addr_h[T::m_levels["bank"]]) {
         bank->m_state = T::m_states["Closed"];
-        bank->m_row_state.clear();
+        bank->clear_open_row();
       }
     }
   };
@@ -71,9 +71,9 @@ namespace BankGroup {
   void ACT4b_bg(typename T::Node* node, int cmd, const AddrHierarchy_t& addr_h, Clk_t clk) {
     for (auto bank : node->m_child_nodes) {
       // assert(bank->m_state == T::m_states["Closed"]);
-      // assert(bank->m_row_state.size() == 0);
+      // assert(bank->get_open_row() == DRAMOpenRows::NO_OPEN_ROW);
       bank->m_state = T::m_states["Opened"];
-      bank->m_row_state[addr_h[T::m_levels["row"]]] = T::m_states["Opened"];
+      bank->set_open_row(addr_h[T::m_levels["row"]]);
     }
   };
 
@@ -81,7 +81,7 @@ namespace BankGroup {
   void PRE4b_bg(typename T::Node* node, int cmd, const AddrHierarchy_t& addr_h, Clk_t clk) {
     for (auto bank : node->m_child_nodes) {
       bank->m_state = T::m_states["Closed"];
-      bank->m_row_state.clear();
+      bank->clear_open_row();
     }
   };
 
@@ -108,13 +108,13 @@ namespace Rank {
     if constexpr (T::m_levels["bank"] - T::m_levels["rank"] == 1) {
       for (auto bank : node->m_child_nodes) {
         bank->m_state = T::m_states["Closed"];
-        bank->m_row_state.clear();
+        bank->clear_open_row();
       }
     } else if constexpr (T::m_levels["bank"] - T::m_levels["rank"] == 2) {
       for (auto bg : node->m_child_nodes) {
         for (auto bank : bg->m_child_nodes) {
           bank->m_state = T::m_states["Closed"];
-          bank->m_row_state.clear();
+          bank->clear_open_row();
         }
       }
     } else {
@@ -149,7 +149,7 @@ namespace Rank {
       for (auto bank : bg->m_child_nodes) {
         if (bank->m_node_id == addr_h[T::m_levels["bank"]]) {
           bank->m_state = T::m_states["Closed"];
-          bank->m_row_state.clear();
+          bank->clear_open_row();
         }
       }
     }
@@ -160,10 +160,29 @@ namespace Rank {
     for (auto bg : node->m_child_nodes) {
       for (auto bank : bg->m_child_nodes) {
         bank->m_state = T::m_states["Opened"];
-        bank->m_row_state[addr_h[T::m_levels["row"]]] = T::m_states["Opened"];
+        bank->set_open_row(addr_h[T::m_levels["row"]]);
       }
     }
   };
+
+  // AiM; the same bank of every bankgroup (inter-bankgroup 4-bank commands)
+  template <class T>
+  void ACT4b_sb(typename T::Node* node, int cmd, const AddrHierarchy_t& addr_h, Clk_t clk) {
+    for (auto bg : node->m_child_nodes) {
+      auto bank = bg->m_child_nodes[addr_h[T::m_levels["bank"]]];
+      bank->m_state = T::m_states["Opened"];
+      bank->set_open_row(addr_h[T::m_levels["row"]]);
+    }
+  };
+
+  template <class T>
+  void PRE4b_sb(typename T::Node* node, int cmd, const AddrHierarchy_t& addr_h, Clk_t clk) {
+    for (auto bg : node->m_child_nodes) {
+      auto bank = bg->m_child_nodes[addr_h[T::m_levels["bank"]]];
+      bank->m_state = T::m_states["Closed"];
+      bank->clear_open_row();
+    }
+  };
 }       // namespace Rank
 
 namespace Channel {
@@ -172,7 +191,7 @@ namespace Channel {
   void PREab(typename T::Node* node, int cmd, const AddrHierarchy_t& addr_h, Clk_t clk) {
     auto precharge_bank = [&](typename T::Node* bank) {
       bank->m_state = T::m_states["Closed"];
-      bank->m_row_state.clear();
+      bank->clear_open_row();
     };
     
     if constexpr (T::m_levels["bank"] - T::m_levels["channel"] == 2) {
@@ -244,7 +263,7 @@ namespace Channel {
     // This lambda encapsulates the state change for a single bank.
     auto activate_bank = [&](typename T::Node* bank) {
       bank->m_state = T::m_states["Opened"];
-      bank->m_row_state[addr_h[T::m_levels["row"]]] = T::m_states["Opened"];
+      bank->set_open_row(addr_h[T::m_levels["row"]]);
     };
 
     // Statically choose the correct traversal path based on the DRAM hierarchy.
@@ -14,7 +14,7 @@ namespace Bank {
     switch (node->m_state) {
       case T::m_states["Closed"]: return T::m_commands["ACT"];
       case T::m_states["Opened"]:
-        if (node->m_row_state.find(addr_h[T::m_levels["row"]]) != node->m_row_state.end()) { return cmd; }
+        if (node->is_row_open(addr_h[T::m_levels["row"]])) { return cmd; }
         else { return T::m_commands["PRE"]; }
       case T::m_states["Refreshing"]: return cmd;
       default: {
@@ -49,7 +49,7 @@ namespace BankGroup {
       switch (bank->m_state) {
         case T::m_states["Opened"]:
           // The bank is open. Check if it's open to the correct row.
-          if (bank->m_row_state.find(addr_h[T::m_levels["row"]]) != bank->m_row_state.end()) { num_open_banks++; }
+          if (bank->is_row_open(addr_h[T::m_levels["row"]])) { num_open_banks++; }
           // This bank is open to the WRONG row. A conflict exists.
           // The entire group must be precharged to resolve it.
           else { return T::m_commands["PRE4_BG"]; }
@@ -117,14 +117,14 @@ namespace Rank {
       num_banks++;
       switch (bank->m_state) {
         case T::m_states["Opened"]:
-          if (bank->m_row_state.find(addr_h[T::m_levels["row"]]) != bank->m_row_state.end()) { num_open_banks++; }
+          if (bank->is_row_open(addr_h[T::m_levels["row"]])) { num_open_banks++; }
           // CONFLICT: Wrong row is fully open.
           else { return 0; }
           break;
         case T::m_states["Pre-Opened"]:
           // Also check Pre-Opened for LPDDR5
           // Bank is open. Check if it's the correct row.
-          if (bank->m_row_state.find(addr_h[T::m_levels["row"]]) != bank->m_row_state.end()) { num_preopen_banks++; }
+          if (bank->is_row_open(addr_h[T::m_levels["row"]])) { num_preopen_banks++; }
           // CONFLICT: Wrong row is pre-opened.
           else { return 0; }
           break;
@@ -213,6 +213,39 @@ namespace Rank {
     if (all_banks_ready) { return cmd; }
     else { return T::m_commands["PREsb"]; }
   };
+
+  /*** For devices with a single-step ACT (GDDR6); the children of the node are the bankgroups ***/
+  template <class T>
+  int RequireSameBankRowsOpen(typename T::Node* node, int cmd, const AddrHierarchy_t& addr_h, Clk_t clk) {
+    int num_open_banks = 0;
+    int num_closed_banks = 0;
+
+    // The inter-bankgroup 4-bank commands access the same bank of every bankgroup
+    for (auto bg : node->m_child_nodes) {
+      auto bank = bg->m_child_nodes[addr_h[T::m_levels["bank"]]];
+      switch (bank->m_state) {
+        case T::m_states["Opened"]:
+          if (bank->is_row_open(addr_h[T::m_levels["row"]])) { num_open_banks++; }
+          // CONFLICT: Wrong row is open.
+          else { return T::m_commands["PRE4_BKS"]; }
+          break;
+        case T::m_states["Closed"]:
+          num_closed_banks++;
+          break;
+        // Timing constraints (REFab -> ACT4_BKS) enforce the wait
+        case T::m_states["Refreshing"]: return cmd;
+        default:
+          spdlog::error("[Preq::Rank] Invalid bank state for the inter-bankgroup 4-bank AiM commands!");
+          std::exit(-1);
+      }
+    }
+
+    const int num_banks = node->m_child_nodes.size();
+    if (num_open_banks == num_banks) { return cmd; }
+    else if (num_closed_banks == num_banks) { return T::m_commands["ACT4_BKS"]; }
+    // MIXED CASE: precharge the same banks to get a uniform state.
+    else { return T::m_commands["PRE4_BKS"]; }
+  };
 }       // namespace Rank
 
 namespace Channel {
@@ -232,7 +265,7 @@ namespace Channel {
       switch (bank->m_state) {
         case T::m_states["Opened"]:
           // Bank is open. Check if it's the correct row.
-          if (bank->m_row_state.find(addr_h[T::m_levels["row"]]) != bank->m_row_state.end()) { num_open_banks++; }
+          if (bank->is_row_open(addr_h[T::m_levels["row"]])) { num_open_banks++; }
           // Conflict: Bank is open to the WRONG row. Must precharge everything.
           else { return 0; }
           break;
@@ -12,7 +12,7 @@ namespace Bank {
     switch (node->m_state)  {
       case T::m_states["Closed"]: return false;
       case T::m_states["Opened"]:
-        if (node->m_row_state.find(target_id) != node->m_row_state.end()) { return true; }
+        if (node->is_row_open(target_id)) { return true; }
         else { return false;}
       case T::m_states["Refreshing"]: return false;
       default: {
@@ -28,7 +28,7 @@ namespace BankGroup {
   bool RD4(typename T::Node* node, int cmd, int target_id, Clk_t clk) {
     for (auto bank : node->m_child_nodes) {
       if (bank->m_state != T::m_states["Opened"]) { return false; }
-      if (bank->m_row_state.find(target_id) == bank->m_row_state.end()) { return false; }
+      if (!bank->is_row_open(target_id)) { return false; }
     }
     return true;
   }
@@ -41,7 +41,7 @@ namespace Channel {
       for (auto bg : node->m_child_nodes) {
         for (auto bank : bg->m_child_nodes) {
           if (bank->m_state != T::m_states["Opened"]) { return false; }
-          if (bank->m_row_state.find(target_id) == bank->m_row_state.end()) { return false; }
+          if (!bank->is_row_open(target_id)) { return false; }
         }
       }
       return true;
@@ -50,7 +50,7 @@ namespace Channel {
         for (auto bg : pc->m_child_nodes) {
           for (auto bank : bg->m_child_nodes) {
             if (bank->m_state != T::m_states["Opened"]) { return false; }
-            if (bank->m_row_state.find(target_id) == bank->m_row_state.end()) { return false; }
+            if (!bank->is_row_open(target_id)) { return false; }
           }
         }
       }
@@ -8,6 +8,8 @@
 #include <array>
 #include <ranges>
 #include <stdexcept>
+#include <algorithm>
+#include <limits>
 
 #include <spdlog/spdlog.h>
 
@@ -42,6 +44,55 @@ namespace Ramulator {
     Clk_t clk;
   };
 
+  /**
+   * @brief     A min-heap of future actions keyed by the cycle they are due at.
+   * @details
+   * Actions due at the same cycle are popped in the order they were pushed.
+   * 
+   */
+  class FutureActionQueue {
+    public:
+      void push(const FutureAction& action) {
+        m_heap.push_back({action, m_num_pushed++});
+        std::push_heap(m_heap.begin(), m_heap.end(), is_later);
+      };
+
+      /**
+       * @brief     Pops the earliest action into action if it is due at or before clk.
+       * 
+       */
+      bool pop_due(Clk_t clk, FutureAction& action) {
+        if (m_heap.empty() || m_heap.front().action.clk > clk) {
+          return false;
+        }
+        std::pop_heap(m_heap.begin(), m_heap.end(), is_later);
+        action = m_heap.back().action;
+        m_heap.pop_back();
+        return true;
+      };
+
+      // The cycle of the earliest action (or the maximum cycle if there is none)
+      Clk_t next_clk() const {
+        return m_heap.empty() ? std::numeric_limits<Clk_t>::max() : m_heap.front().action.clk;
+      };
+
+      size_t size() const { return m_heap.size(); };
+      bool empty() const { return m_heap.empty(); };
+
+    private:
+      struct Entry {
+        FutureAction action;
+        uint64_t seq;
+      };
+
+      static bool is_later(const Entry& e1, const Entry& e2) {
+        return e1.action.clk != e2.action.clk ? e1.action.clk > e2.action.clk : e1.seq > e2.seq;
+      };
+
+      std::vector<Entry> m_heap;
+      uint64_t m_num_pushed = 0;
+  };
+
   // Timing Constraint
   struct TimingConsEntry {
     /// The command that the timing constraint is constraining.
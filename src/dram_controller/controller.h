@@ -32,7 +32,7 @@ class IDRAMController : public Clocked<IDRAMController> {
     /**
      * @brief       Send a request to the memory controller.
      * 
-     * @param    req        The request to be enqueued.
+     * @param    req        The request to be enqueued. It is moved into the controller if accepted.
      * @return   true       Successful.
      * @return   false      Failed (e.g., buffer full).
      */
@@ -40,6 +40,7 @@ class IDRAMController : public Clocked<IDRAMController> {
 
     /**
      * @brief       Send a high-priority request to the memory controller.
+     *              The request is moved into the controller if accepted.
      * 
      */
     virtual bool priority_send(Request& req) = 0;
@@ -49,6 +50,69 @@ class IDRAMController : public Clocked<IDRAMController> {
      * 
      */
     virtual void tick() = 0;
+
+    /**
+     * @brief       Returns the earliest cycle at which the controller may change its state.
+     * @details
+     * Used by event-driven fast-forwarding. If the last tick did not change anything, the controller
+     * (and its channel) stays unchanged until the returned cycle. The default is conservative (i.e., the next cycle).
+     * 
+     */
+    virtual Clk_t get_next_event_clk() { return m_clk + 1; };
+
+    /**
+     * @brief       Advances the controller over cycles in which nothing happens.
+     * 
+     */
+    virtual void fast_forward(Clk_t num_cycles) { m_clk += num_cycles; };
+
+    /**
+     * @brief       Returns whether no buffered request targets the rank.
+     * @details
+     * Refresh managers pull refreshes in while a rank is idle. The default is conservative (i.e., never idle).
+     * 
+     */
+    virtual bool is_rank_idle(int rank_id) { return false; };
+
+    /**
+     * @brief       Returns whether the rank is at a row boundary (i.e., no request is working on an open row of it).
+     * @details
+     * Refresh managers postpone refreshes until a rank reaches a row boundary, so that a refresh does not close
+     * the rows a burst of accesses is still hitting. The default never postpones (i.e., always at a boundary).
+     * 
+     */
+    virtual bool is_rank_at_row_boundary(int rank_id) { return true; };
+
+    /**
+     * @brief       Returns whether every request sent to the controller has been served.
+     * @details
+     * Maintenance requests (e.g., refreshes) are not counted. The default is always idle.
+     * 
+     */
+    virtual bool is_idle() { return true; };
+
+    /**
+     * @brief       Makes the controller move the served requests into the list instead of calling their callbacks.
+     * @details
+     * A memory system ticking its controllers in parallel calls the callbacks itself, from one thread and in channel order.
+     * A null list makes tick() call the callbacks again. Returns false if the controller does not support it (the default).
+     * 
+     */
+    virtual bool defer_callbacks(std::vector<Request>*) { return false; };
+
+    /**
+     * @brief       Returns the names of the statistics the controller reports every epoch.
+     * @details
+     * The memory system samples them every epoch into a time series. The default reports nothing.
+     * 
+     */
+    virtual std::vector<std::string> get_epoch_stat_names() { return {}; };
+
+    /**
+     * @brief       Appends the current values of the epoch statistics (in the order of get_epoch_stat_names()).
+     * 
+     */
+    virtual void sample_epoch_stats(std::vector<int64_t>&) {};
    
   protected:
     enum class SendFalseType {
@@ -0,0 +1,63 @@
+#ifndef     RAMULATOR_CONTROLLER_AIM_COMPLETION_QUEUE_H
+#define     RAMULATOR_CONTROLLER_AIM_COMPLETION_QUEUE_H
+
+#include <vector>
+#include <limits>
+#include <algorithm>
+
+#include "base/type.h"
+#include "base/AiM_request.h"
+
+namespace Ramulator {
+
+/**
+ * @brief     A min-heap of the requests that are about to finish, keyed by their depart cycle.
+ * @details
+ * Requests departing at the same cycle are popped in the order they were pushed (i.e., issued).
+ *
+ */
+class AiMCompletionQueue {
+  public:
+    void push(Request&& req) {
+      m_heap.push_back({m_num_pushed++, std::move(req)});
+      std::push_heap(m_heap.begin(), m_heap.end(), is_later);
+    };
+
+    // Whether the earliest request departs at or before clk
+    bool has_due(Clk_t clk) const {
+      return !m_heap.empty() && m_heap.front().req.depart <= clk;
+    };
+
+    // Removes the earliest request and returns it
+    Request pop() {
+      std::pop_heap(m_heap.begin(), m_heap.end(), is_later);
+      Request req = std::move(m_heap.back().req);
+      m_heap.pop_back();
+      return req;
+    };
+
+    // The depart cycle of the earliest request (or the maximum cycle if there is none)
+    Clk_t next_clk() const {
+      return m_heap.empty() ? std::numeric_limits<Clk_t>::max() : m_heap.front().req.depart;
+    };
+
+    size_t size() const { return m_heap.size(); };
+    bool empty() const { return m_heap.empty(); };
+
+  private:
+    struct Entry {
+      uint64_t seq;
+      Request req;
+    };
+
+    static bool is_later(const Entry& e1, const Entry& e2) {
+      return e1.req.depart != e2.req.depart ? e1.req.depart > e2.req.depart : e1.seq > e2.seq;
+    };
+
+    std::vector<Entry> m_heap;
+    uint64_t m_num_pushed = 0;
+};
+
+}        // namespace Ramulator
+
+#endif   // RAMULATOR_CONTROLLER_AIM_COMPLETION_QUEUE_H
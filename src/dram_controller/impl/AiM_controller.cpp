@@ -2,8 +2,11 @@
 #include "memory_system/memory_system.h"
 // AiM
 #include "base/AiM_request.h"
+#include "dram_controller/impl/AiM_latency_histogram.h"
+#include "dram_controller/impl/AiM_completion_queue.h"
 #include <cstdio>
 #include <string>
+#include <unordered_map>
 
 #include <iomanip>
 
@@ -20,6 +23,32 @@ class AiMController final : public IDRAMController, public Implementation {
     void init() override {
       m_wr_low_watermark =  param<float>("wr_low_watermark").desc("Threshold for switching back to read mode.").default_val(0.2f);
       m_wr_high_watermark = param<float>("wr_high_watermark").desc("Threshold for switching to write mode.").default_val(0.8f);
+      std::string mode_switch_policy = param<std::string>("mode_switch_policy").desc("How the controller switches between serving host RD/WR requests and AiM requests (Exclusive, Watermark, TimeSlice or Cost). Exclusive only accepts one kind of request at a time.").default_val("Exclusive");
+      if (mode_switch_policy == "Exclusive") {
+        m_mode_switch_policy = ModeSwitchPolicy::Exclusive;
+      } else if (mode_switch_policy == "Watermark") {
+        m_mode_switch_policy = ModeSwitchPolicy::Watermark;
+      } else if (mode_switch_policy == "TimeSlice") {
+        m_mode_switch_policy = ModeSwitchPolicy::TimeSlice;
+      } else if (mode_switch_policy == "Cost") {
+        m_mode_switch_policy = ModeSwitchPolicy::Cost;
+      } else {
+        throw ConfigurationError("AiMController: unknown mode_switch_policy ({})!", mode_switch_policy);
+      }
+      m_mode_switch_latency = param<int>("mode_switch_latency").desc("Number of cycles it takes to switch between the host and PIM modes (-1: max(10ns, 5nCK), i.e., tMRW of LPDDR5).").default_val(-1);
+      m_host_high_watermark = param<float>("host_high_watermark").desc("Watermark: occupancy of the RD/WR buffers above which the PIM mode is left.").default_val(0.8f);
+      m_pim_high_watermark = param<float>("pim_high_watermark").desc("Watermark: occupancy of the AiM bank buffer above which the host mode is left.").default_val(0.8f);
+      m_host_time_slice = param<int>("host_time_slice").desc("TimeSlice: cycles the host mode is kept while AiM requests wait.").default_val(500);
+      m_pim_time_slice = param<int>("pim_time_slice").desc("TimeSlice: cycles the PIM mode is kept while RD/WR requests wait.").default_val(2000);
+      m_mode_switch_cost_factor = param<float>("mode_switch_cost_factor").desc("Cost: the mode is switched once the cycles the waiting requests have spent exceed this factor times the cycles the switch costs the served ones.").default_val(16.0f);
+      if (m_host_time_slice <= 0 || m_pim_time_slice <= 0) {
+        throw ConfigurationError("AiMController: host_time_slice ({}) and pim_time_slice ({}) must be positive!", m_host_time_slice, m_pim_time_slice);
+      }
+      m_is_latency_histogram_enabled = param<bool>("latency_histograms").desc("Report histograms (and p50/p99/p999) of the queueing, service and end-to-end latencies of every request type.").default_val(false);
+      if (m_is_latency_histogram_enabled) {
+        m_latency_histograms.resize(Request::Type::UNKNOWN);
+      }
+      m_report_completion_lag = param<bool>("report_completion_lag").desc("Report how late the requests would complete if the reads and AiM requests were retired in order, one per queue per cycle.").default_val(false);
       // m_clock_ratio = param<uint>("clock_ratio").required();
 
       m_scheduler = create_child_ifce<IScheduler>();
@@ -37,7 +66,29 @@ class AiMController final : public IDRAMController, public Implementation {
     void setup(IFrontEnd* frontend, IMemorySystem* memory_system) override {
       m_dram = memory_system->get_ifce<IDRAM>();
       m_bank_addr_idx = m_dram->m_levels("bank");
+      m_rank_addr_idx = m_dram->m_levels.contains("rank") ? m_dram->m_levels("rank") : -1;
+      m_row_addr_idx = m_dram->m_levels("row");
+      m_num_ranks = m_rank_addr_idx != -1 ? m_dram->m_organization.count[m_rank_addr_idx] : 1;
+      m_rank_buffered_counts.assign(m_num_ranks + 1, 0);
+      m_rank_aim_counts.assign(m_num_ranks + 1, 0);
+      m_rank_host_row_hits.assign(m_num_ranks + 1, 0);
+      m_is_at_row_boundary.assign(m_num_ranks, true);
+      m_is_rank_resolved.assign(m_num_ranks, false);
+      // One counter per node of the channel from the channel (a single node) down to the banks
+      m_active_counts.resize(m_bank_addr_idx + 1);
+      m_active_depth_counts.resize(m_bank_addr_idx + 1);
+      for (int level = 0, num_nodes = 1; level <= m_bank_addr_idx; level++) {
+        if (level > 0) {
+          num_nodes *= m_dram->m_organization.count[level];
+        }
+        m_active_counts[level].assign(num_nodes, 0);
+        m_active_depth_counts[level].assign(num_nodes, 0);
+      }
       m_priority_buffer.max_size = 512 * 3 + 32;
+      if (m_mode_switch_latency < 0) {
+        int tCK_ps = m_dram->m_timing_vals("tCK_ps");
+        m_mode_switch_latency = std::max((10000 + tCK_ps - 1) / tCK_ps, 5);
+      }
       auto existing_logger = Logging::get("AiMController[" + std::to_string(m_channel_id) + "]");
       if (existing_logger) {
         m_logger = existing_logger;
@@ -64,8 +115,8 @@ class AiMController final : public IDRAMController, public Implementation {
       }
       for (const auto type : {Request::Type::MAC_SBK, Request::Type::AF_SBK, Request::Type::COPY_BKGB, Request::Type::COPY_GBBK,
                               Request::Type::MAC_4BK_INTRA_BG, Request::Type::AF_4BK_INTRA_BG, Request::Type::EWMUL, Request::Type::EWADD,
-                              Request::Type::MAC_ABK, Request::Type::AF_ABK, Request::Type::WR_AFLUT, Request::Type::WR_BK}) {
-        // Request::Type::MAC_4BK_INTER_BG, Request::Type::AF_4BK_INTER_BG,
+                              Request::Type::MAC_ABK, Request::Type::AF_ABK, Request::Type::WR_AFLUT, Request::Type::WR_BK,
+                              Request::Type::MAC_4BK_INTER_BG, Request::Type::AF_4BK_INTER_BG}) {
         s_num_AiM_bank_cycles[type] = 0;
         // register_stat(s_num_AiM_bank_cycles[type])
         //   .name(fmt::format("CH{}_AiM_{}_cycles", m_channel_id, str_type_name(type)));
@@ -93,6 +144,24 @@ class AiMController final : public IDRAMController, public Implementation {
         .name(fmt::format("CH{}_active_cycles", m_channel_id));
       register_stat(s_num_precharged_cycles)
         .name(fmt::format("CH{}_precharged_cycles", m_channel_id));
+      if (m_mode_switch_policy != ModeSwitchPolicy::Exclusive) {
+        register_stat(s_host_mode_cycles)
+          .name(fmt::format("CH{}_host_mode_cycles", m_channel_id));
+        register_stat(s_pim_mode_cycles)
+          .name(fmt::format("CH{}_pim_mode_cycles", m_channel_id));
+        register_stat(s_mode_switch_cycles)
+          .name(fmt::format("CH{}_mode_switch_cycles", m_channel_id));
+        register_stat(s_num_mode_switches)
+          .name(fmt::format("CH{}_num_mode_switches", m_channel_id));
+      }
+      if (m_report_completion_lag) {
+        register_stat(s_num_lagged_completions)
+          .name(fmt::format("CH{}_num_lagged_completions", m_channel_id));
+        register_stat(s_completion_lag_cycles)
+          .name(fmt::format("CH{}_completion_lag_cycles", m_channel_id));
+        register_stat(s_max_completion_lag_cycles)
+          .name(fmt::format("CH{}_max_completion_lag_cycles", m_channel_id));
+      }
 
       // register_stat(s_row_hits).name("row_hits_{}", m_channel_id);
       // register_stat(s_row_misses).name("row_misses_{}", m_channel_id);
@@ -121,9 +190,6 @@ class AiMController final : public IDRAMController, public Implementation {
       // register_stat(s_read_queue_len_avg).name("read_queue_len_avg_{}", m_channel_id);
       // register_stat(s_write_queue_len_avg).name("write_queue_len_avg_{}", m_channel_id);
       // register_stat(s_priority_queue_len_avg).name("priority_queue_len_avg_{}", m_channel_id);
-
-      // register_stat(s_read_latency).name("read_latency_{}", m_channel_id);
-      // register_stat(s_avg_read_latency).name("avg_read_latency_{}", m_channel_id);
     };
 
     bool send(Request& req) override {
@@ -132,8 +198,10 @@ class AiMController final : public IDRAMController, public Implementation {
                 "[AiMulator: Ctrl, CH{} send()] type: {} addr: 0x{:x} is_aim: {} aim_num_banks: {}",
                 m_channel_id, req.type_id, req.addr, req.is_aim_req, req.aim_num_banks);
 
+      // Unless the host and PIM modes are switched between, only one kind of requests is accepted at a time
+      bool is_exclusive = m_mode_switch_policy == ModeSwitchPolicy::Exclusive;
       if (!req.is_aim_req) {
-        if (m_aim_bank_buffer.size() != 0 || m_aim_no_bank_buffer.size() != 0) {
+        if (is_exclusive && (m_aim_bank_buffer.size() != 0 || m_aim_no_bank_buffer.size() != 0)) {
           DEBUG_LOG(AiMController, m_logger, 
                     "[AiMulator: Ctrl, CH{} send()] REJECTED: AiM buffer not empty",
                     m_channel_id);
@@ -141,7 +209,7 @@ class AiMController final : public IDRAMController, public Implementation {
         }
         req.final_command = m_dram->m_request_translations(req.type_id);
       } else {
-        if (m_write_buffer.size() != 0 || m_read_buffer.size() != 0) {
+        if (is_exclusive && (m_write_buffer.size() != 0 || m_read_buffer.size() != 0)) {
           DEBUG_LOG(AiMController, m_logger,
                     "[AiMulator: Ctrl, CH{} send()] REJECTED: RD/WR buffer not empty",
                     m_channel_id);
@@ -154,13 +222,10 @@ class AiMController final : public IDRAMController, public Implementation {
 
       // Forward existing write requests to incoming read requests
       if (req.type_id == Request::Type::Read) {
-        auto compare_addr = [req](const Request& wreq) {
-          return wreq.addr == req.addr;
-        };
-        if (std::find_if(m_write_buffer.begin(), m_write_buffer.end(), compare_addr) != m_write_buffer.end()) {
+        if (m_write_addr_counts.contains(req.addr)) {
           // The request will depart at the next cycle
           req.depart = m_clk + 1;
-          pending_reads.push(req);
+          push_completion(std::move(req), LegacyQueue::Read);
           return true;
         }
       }
@@ -169,28 +234,31 @@ class AiMController final : public IDRAMController, public Implementation {
       bool is_success = false;
       req.arrive = m_clk;
       if (req.type_id == Request::Type::Read) {
-        if (!m_read_buffer.enqueue(req)) {
+        if (!m_read_buffer.enqueue(std::move(req))) {
           req.arrive = -1;
           DEBUG_LOG(AiMController, m_logger, "Read Buffer FULL!");
           return false;
         }
+        update_buffer_counts(&m_read_buffer, m_read_buffer.back(), 1);
       } else if (req.type_id == Request::Type::Write) {
-        if (!m_write_buffer.enqueue(req)) {
+        if (!m_write_buffer.enqueue(std::move(req))) {
           req.arrive = -1;
           DEBUG_LOG(AiMController, m_logger, "Write Buffer FULL!");
           return false;
         }
+        update_buffer_counts(&m_write_buffer, m_write_buffer.back(), 1);
       } else if (req.is_aim_req && req.aim_num_banks != 0) {
-        if (!m_aim_bank_buffer.enqueue(req)) {
+        if (!m_aim_bank_buffer.enqueue(std::move(req))) {
           req.arrive = -1;
           DEBUG_LOG(AiMController, m_logger, "AiM Bank Buffer FULL!");
           return false;
         }
+        update_buffer_counts(&m_aim_bank_buffer, m_aim_bank_buffer.back(), 1);
         DEBUG_LOG(AiMController, m_logger, 
                   "[AiMulator: Ctrl, CH{} send()] Enqueued to m_aim_bank_buffer, size={}", 
                   m_channel_id, m_aim_bank_buffer.size());
       } else if (req.is_aim_req && req.aim_num_banks == 0) {
-        if (!m_aim_no_bank_buffer.enqueue(req)) {
+        if (!m_aim_no_bank_buffer.enqueue(std::move(req))) {
           req.arrive = -1;
           DEBUG_LOG(AiMController, m_logger, "AiM NO-Bank Buffer FULL!");
           return false;
@@ -213,7 +281,7 @@ class AiMController final : public IDRAMController, public Implementation {
       }
 
       bool is_success = false;
-      is_success = m_priority_buffer.enqueue(req);
+      is_success = m_priority_buffer.enqueue(std::move(req));
       return is_success;
     }
 
@@ -222,9 +290,9 @@ class AiMController final : public IDRAMController, public Implementation {
       m_clk++;
 
       DEBUG_LOG(AiMController, m_logger, 
-                "[AiMulator: Ctrl, CH{} tick()] clk={} aim_bank_buf={} aim_no_bank_buf={} pending_aim_bank={} pending_aim_no_bank={}", 
+                "[AiMulator: Ctrl, CH{} tick()] clk={} aim_bank_buf={} aim_no_bank_buf={} pending_completions={}", 
                 m_channel_id, m_clk, m_aim_bank_buffer.size(), m_aim_no_bank_buffer.size(),
-                pending_aim_bank.size(), pending_aim_no_bank.size());
+                m_pending_completions.size());
 
       // Update statistics
       // s_queue_len += m_read_buffer.size() + m_write_buffer.size() + m_priority_buffer.size() + pending_reads.size();
@@ -233,14 +301,23 @@ class AiMController final : public IDRAMController, public Implementation {
       // s_priority_queue_len += m_priority_buffer.size();
 
       // 1. Serve completed reads
-      serve_completed_reqs();
+      bool reqs_served = serve_completed_reqs();
 
+      size_t num_priority_reqs = m_priority_buffer.size();
       m_refresh->tick();
 
       // 2. Try to find a request to serve.
       ReqBuffer::iterator req_it;
       ReqBuffer* buffer = nullptr;
+      bool is_write_mode = m_is_write_mode;
+      bool is_pim_mode = m_is_pim_mode;
       bool request_found = schedule_request(req_it, buffer);
+      update_mode_stats(1);
+
+      // Remember whether this tick changed anything (for fast-forwarding)
+      m_is_state_changed = reqs_served || request_found ||
+                           m_priority_buffer.size() != num_priority_reqs || m_is_write_mode != is_write_mode ||
+                           m_is_pim_mode != is_pim_mode;
       
       DEBUG_LOG(AiMController, m_logger, "[AiMulator: Ctrl, CH{} tick()] request_found={}",
                 m_channel_id, request_found);
@@ -278,6 +355,8 @@ class AiMController final : public IDRAMController, public Implementation {
           DEBUG_LOG(AiMController, m_logger, 
                     "[AiMulator: Ctrl, CH{} tick()] Final command issued, type={} addr=0x{:x} depart={}", 
                     m_channel_id, req_it->type_id, req_it->addr, req_it->depart);
+          // Take the request out of the buffer counts while it is still live, as it is moved to its completion queue below
+          update_buffer_counts(buffer, *req_it, -1);
           // Route completed requests to appropriate pending queues
           // IMPORTANT: Check is_aim_req to avoid routing refresh/system requests
           // (which may have type_id values that collide with AiM types) to AiM pending queues
@@ -296,19 +375,19 @@ class AiMController final : public IDRAMController, public Implementation {
               case Request::Type::AF_ABK:
               case Request::Type::WR_AFLUT:
               case Request::Type::WR_BK:
-                pending_aim_bank.push(*req_it);
+              case Request::Type::MAC_4BK_INTER_BG:
+              case Request::Type::AF_4BK_INTER_BG:
                 s_num_AiM_bank_cycles[req_it->type_id] += (m_clk - req_it->issue);
+                push_completion(std::move(*req_it), LegacyQueue::AiMBank);
                 break;
               case Request::Type::WR_GB:
               case Request::Type::WR_MAC:
               case Request::Type::WR_BIAS:
               case Request::Type::RD_MAC:
               case Request::Type::RD_AF:
-                pending_aim_no_bank.push(*req_it);
                 s_num_AiM_no_bank_cycles[req_it->type_id] += (m_clk - req_it->issue);
+                push_completion(std::move(*req_it), LegacyQueue::AiMNoBank);
                 break;
-              // case Request::Type::MAC_4BK_INTER_BG:
-              // case Request::Type::AF_4BK_INTER_BG:
               default:
                 spdlog::error("Not defined request type!");
                 std::exit(-1);
@@ -317,25 +396,26 @@ class AiMController final : public IDRAMController, public Implementation {
             // Non-AiM requests (Read, Write, Refresh, etc.)
             switch (req_it->type_id) {
               case Request::Type::Read:
-                pending_reads.push(*req_it);
                 s_num_RW_cycles[req_it->type_id] += (m_clk - req_it->issue);
+                push_completion(std::move(*req_it), LegacyQueue::Read);
                 break;
               case Request::Type::Write:
-                pending_writes.push_back(*req_it);
                 s_num_RW_cycles[req_it->type_id] += (m_clk - req_it->issue);
+                push_completion(std::move(*req_it), LegacyQueue::None);
                 break;
               default:
                 // Refresh and other system commands - no pending queue needed,
                 // they complete immediately after final command is issued
+                if (req_it->callback) {
+                  req_it->callback(*req_it);
+                }
                 break;
             }
           }
           buffer->remove(req_it);
         } else {
-          if (m_dram->m_command_meta(req_it->command).is_opening) {
-            if (m_active_buffer.enqueue(*req_it)) {
-              buffer->remove(req_it);
-            }
+          if (m_dram->m_command_meta(req_it->command).is_opening && !req_it->is_row_prefetched) {
+            move_request(buffer, req_it, &m_active_buffer);
           }
         }
       } else if (m_read_buffer.size() == 0 && m_write_buffer.size() == 0
@@ -350,10 +430,116 @@ class AiMController final : public IDRAMController, public Implementation {
       }
     };
 
+    Clk_t get_next_event_clk() override {
+      if (m_is_state_changed) {
+        return m_clk + 1;
+      }
+
+      Clk_t next_event_clk = m_refresh->get_next_event_clk();
+      next_event_clk = std::min(next_event_clk, m_pending_completions.next_clk());
+      if (m_clk < m_mode_switch_done_clk) {
+        next_event_clk = std::min(next_event_clk, m_mode_switch_done_clk);
+      }
+      // The time slices and the waiting costs of the two modes change every cycle
+      if ((m_mode_switch_policy == ModeSwitchPolicy::TimeSlice || m_mode_switch_policy == ModeSwitchPolicy::Cost) &&
+          has_host_requests() && has_pim_requests()) {
+        return m_clk + 1;
+      }
+      // Buffered requests can only be scheduled once a timing constraint of the channel expires
+      if (m_active_buffer.size() || m_priority_buffer.size() || m_read_buffer.size() || m_write_buffer.size() ||
+          m_aim_bank_buffer.size() || m_aim_no_bank_buffer.size()) {
+        next_event_clk = std::min(next_event_clk, m_dram->get_next_ready_clk(m_channel_id));
+      }
+      return next_event_clk;
+    };
+
+    void fast_forward(Clk_t num_cycles) override {
+      // The cycles being skipped are m_clk + 1 to m_clk + num_cycles
+      Clk_t num_switch_cycles = std::clamp<Clk_t>(m_mode_switch_done_clk - m_clk - 1, 0, num_cycles);
+      m_clk += num_switch_cycles;
+      update_mode_stats(num_switch_cycles);
+      m_clk += num_cycles - num_switch_cycles;
+      update_mode_stats(num_cycles - num_switch_cycles);
+      m_refresh->fast_forward(num_cycles);
+
+      // Account the skipped cycles exactly as tick() would have done
+      if (m_read_buffer.size() == 0 && m_write_buffer.size() == 0
+          && m_aim_bank_buffer.size() == 0 && m_aim_no_bank_buffer.size() == 0) {
+        s_num_idle_cycles += num_cycles;
+      }
+      if (m_dram->m_open_rows[m_channel_id] == 0) {
+        s_num_precharged_cycles += num_cycles;
+      } else {
+        s_num_active_cycles += num_cycles;
+      }
+    };
+
+    bool defer_callbacks(std::vector<Request>* served_reqs) override {
+      m_deferred_reqs = served_reqs;
+      return true;
+    };
+
+    bool is_idle() override {
+      return m_active_buffer.size() == 0 && m_read_buffer.size() == 0 && m_write_buffer.size() == 0 &&
+             m_aim_bank_buffer.size() == 0 && m_aim_no_bank_buffer.size() == 0 && m_pending_completions.size() == 0;
+    };
+
+    std::vector<std::string> get_epoch_stat_names() override {
+      std::vector<std::string> names;
+      for (int cmd = 0; cmd < (int) m_dram->m_commands.size(); cmd++) {
+        names.push_back(fmt::format("num_{}_commands", std::string(m_dram->m_commands(cmd))));
+      }
+      for (auto cycles : {&s_num_AiM_bank_cycles, &s_num_AiM_no_bank_cycles}) {
+        for (const auto& [type, num_cycles] : *cycles) {
+          names.push_back(fmt::format("AiM_{}_cycles", str_type_name(type)));
+        }
+      }
+      for (const auto name : {"idle_cycles", "active_cycles", "precharged_cycles", "num_completed_requests",
+                              "read_buffer_size", "write_buffer_size", "aim_bank_buffer_size", "aim_no_bank_buffer_size",
+                              "active_buffer_size", "priority_buffer_size", "num_pending_completions"}) {
+        names.push_back(name);
+      }
+      return names;
+    };
+
+    void sample_epoch_stats(std::vector<int64_t>& values) override {
+      // Counters are cumulative; buffer sizes are the ones at the end of the epoch
+      for (const auto& [cmd, num_commands] : s_num_commands) {
+        values.push_back(num_commands);
+      }
+      for (auto cycles : {&s_num_AiM_bank_cycles, &s_num_AiM_no_bank_cycles}) {
+        for (const auto& [type, num_cycles] : *cycles) {
+          values.push_back(num_cycles);
+        }
+      }
+      for (const auto value : {(size_t) s_num_idle_cycles, (size_t) s_num_active_cycles, (size_t) s_num_precharged_cycles,
+                               s_num_completed_reqs,
+                               m_read_buffer.size(), m_write_buffer.size(), m_aim_bank_buffer.size(), m_aim_no_bank_buffer.size(),
+                               m_active_buffer.size(), m_priority_buffer.size(), m_pending_completions.size()}) {
+        values.push_back(value);
+      }
+    };
+
+    bool is_rank_idle(int rank_id) override {
+      return !is_rank_active(rank_id) && m_rank_buffered_counts[rank_id] + m_rank_buffered_counts[m_num_ranks] == 0;
+    };
+
+    bool is_rank_at_row_boundary(int rank_id) override {
+      update_row_boundaries();
+      return m_is_at_row_boundary[rank_id];
+    };
+
   private:
-    // A queue for RD/WR requests that are about to finish (callback after RL)
-    std::queue<Request> pending_reads;
-    std::vector<Request> pending_writes;
+    // RD/WR and AiM requests that are about to finish (callback after RL)
+    AiMCompletionQueue m_pending_completions;
+    size_t s_num_completed_reqs = 0;
+    // The served requests whose callbacks are called by the memory system (see defer_callbacks())
+    std::vector<Request>* m_deferred_reqs = nullptr;
+
+    // Latency histograms of every request type, indexed by [type_id][LatencyKind]
+    enum LatencyKind : int { Queueing = 0, Service, EndToEnd, NumLatencyKinds };
+    bool m_is_latency_histogram_enabled = false;
+    std::vector<std::array<AiMLatencyHistogram, NumLatencyKinds>> m_latency_histograms;
     // std::vector<std::queue<Request>> pending(Request::Type::UNKNOWN+1);
 
     // Buffer for requests being served. This has the highest priority 
@@ -364,13 +550,61 @@ class AiMController final : public IDRAMController, public Implementation {
     ReqBuffer m_read_buffer;
     // Write request buffer
     ReqBuffer m_write_buffer;
+    // The number of requests in the write buffer to each address (for forwarding writes to reads)
+    std::unordered_map<Addr_t, int> m_write_addr_counts;
 
     int m_bank_addr_idx = -1;
+    int m_rank_addr_idx = -1;
+    int m_row_addr_idx = -1;
+
+    // The number of requests in the active buffer that operate on each node (from the channel down to the banks),
+    // indexed by [level][flat id of the node within the channel].
+    // m_active_counts counts the requests whose depth (see get_bank_depth()) is at least the level,
+    // and m_active_depth_counts those whose depth is exactly the level.
+    std::vector<std::vector<int>> m_active_counts;
+    std::vector<std::vector<int>> m_active_depth_counts;
+
+    // Per-rank bookkeeping for the refresh managers (see is_rank_idle() and is_rank_at_row_boundary()),
+    // indexed by rank id, with the requests to every rank (or to a device without ranks) at m_num_ranks
+    int m_num_ranks = 1;
+    // The number of requests in the RD/WR and AiM bank buffers, and in the AiM bank buffer only
+    std::vector<int> m_rank_buffered_counts;
+    std::vector<int> m_rank_aim_counts;
+    // The RD/WR requests hit or miss together if they share their final command, bank and row
+    struct HostRowGroup {
+      int command;
+      AddrHierarchy_t addr_h;
+      int count;
+    };
+    std::unordered_map<uint64_t, HostRowGroup> m_host_row_groups;
+    // Bumped whenever a host row group is created or erased, and whenever a request enters or leaves a counted buffer
+    size_t m_host_row_groups_version = 0;
+    size_t m_buffer_version = 0;
+    // The number of host row groups hitting an open row
+    std::vector<int> m_rank_host_row_hits;
+    // Whether each rank is at a row boundary, valid as long as the versions it was computed at do not change
+    std::vector<bool> m_is_at_row_boundary;
+    std::vector<bool> m_is_rank_resolved;
+    int64_t m_row_boundary_state_version = -1;
+    size_t m_row_boundary_groups_version = 0;
+    size_t m_row_boundary_buffer_version = 0;
 
     float m_wr_low_watermark;
     float m_wr_high_watermark;
     bool  m_is_write_mode = false;
 
+    // The in-order completion queues that used to retire at most one request per cycle each
+    enum class LegacyQueue : int { None = -1, Read = 0, AiMBank, AiMNoBank };
+    bool m_report_completion_lag = false;
+    // The cycle the last request pushed to each legacy queue (indexed by LegacyQueue) would have been retired at
+    std::vector<Clk_t> m_legacy_retire_clk = {-1, -1, -1};
+    size_t s_num_lagged_completions = 0;
+    size_t s_completion_lag_cycles = 0;
+    size_t s_max_completion_lag_cycles = 0;
+
+    // Whether the last tick changed the state of the controller or the device
+    bool m_is_state_changed = true;
+
     // size_t s_row_hits = 0;
     // size_t s_row_misses = 0;
     // size_t s_row_conflicts = 0;
@@ -397,9 +631,6 @@ class AiMController final : public IDRAMController, public Implementation {
     // float s_read_queue_len_avg = 0;
     // float s_write_queue_len_avg = 0;
     // float s_priority_queue_len_avg = 0;
-
-    // size_t s_read_latency = 0;
-    // float s_avg_read_latency = 0;
     
     // Missing parts in Ramulator; Cycles
     std::map<int, int> s_num_commands;
@@ -411,14 +642,66 @@ class AiMController final : public IDRAMController, public Implementation {
     // AiM
     ReqBuffer m_aim_bank_buffer;
     ReqBuffer m_aim_no_bank_buffer;
-    // in-order execution
-    std::queue<Request> pending_aim_bank;
-    std::queue<Request> pending_aim_no_bank;
     std::map<int, int> s_num_AiM_bank_cycles;
     std::map<int, int> s_num_AiM_no_bank_cycles;
-    bool is_reg_RW_mode = false;
+
+    // Whether the host (RD/WR) or the PIM (AiM) requests are served (unless the policy is Exclusive, only one kind
+    // of requests is buffered at a time, and whichever is buffered is served)
+    enum class ModeSwitchPolicy { Exclusive, Watermark, TimeSlice, Cost };
+    ModeSwitchPolicy m_mode_switch_policy = ModeSwitchPolicy::Exclusive;
+    bool m_is_pim_mode = false;
+    int m_mode_switch_latency = -1;
+    float m_host_high_watermark;
+    float m_pim_high_watermark;
+    int m_host_time_slice;
+    int m_pim_time_slice;
+    float m_mode_switch_cost_factor;
+    // The cycle the current mode was switched to, and the one until which the switch is in progress
+    Clk_t m_mode_start_clk = 0;
+    Clk_t m_mode_switch_done_clk = 0;
+    size_t s_host_mode_cycles = 0;
+    size_t s_pim_mode_cycles = 0;
+    size_t s_mode_switch_cycles = 0;
+    size_t s_num_mode_switches = 0;
 
   private:
+    /**
+     * @brief    Helper function to move a request from a buffer to another one, unless the latter is full
+     * @details
+     * The counts of both buffers are updated from the moved request.
+     * 
+     */
+    bool move_request(ReqBuffer* buffer, ReqBuffer::iterator& req_it, ReqBuffer* to_buffer) {
+      if (!to_buffer->enqueue(std::move(*req_it))) {
+        return false;
+      }
+      const Request& req = to_buffer->back();
+      update_buffer_counts(to_buffer, req, 1);
+      update_buffer_counts(buffer, req, -1);
+      buffer->remove(req_it);
+      return true;
+    }
+    /**
+     * @brief    Helper function to add (delta = 1) or remove (delta = -1) a request of the buffer to/from its counts
+     * @details
+     * The active buffer counts the banks of its requests, the write buffer the addresses of its requests (for forwarding),
+     * and the RD/WR and AiM bank buffers the ranks of their requests.
+     */
+    void update_buffer_counts(ReqBuffer* buffer, const Request& req, int delta) {
+      if (buffer == &m_active_buffer) {
+        update_active_counts(req, delta);
+      } else if (buffer == &m_write_buffer) {
+        auto count_it = m_write_addr_counts.try_emplace(req.addr, 0).first;
+        count_it->second += delta;
+        if (count_it->second == 0) {
+          m_write_addr_counts.erase(count_it);
+        }
+      }
+      if (buffer == &m_read_buffer || buffer == &m_write_buffer || buffer == &m_aim_bank_buffer) {
+        update_rank_counts(req, buffer, delta);
+      }
+    }
+
     /**
      * @brief    Helper function to check if a request is hitting an open row
      * @details
@@ -435,6 +718,170 @@ class AiMController final : public IDRAMController, public Implementation {
     bool is_row_open(ReqBuffer::iterator& req) {
       return m_dram->check_node_open(req->final_command, req->addr_h);
     }
+    /**
+     * @brief    Helper function to get the deepest level (at most the bank) whose address a command operates on
+     * @details
+     * 
+     */
+    int get_bank_depth(int command) {
+      Level_t scope = m_dram->m_command_action_scope(command);
+      return (scope == -1 || scope > m_bank_addr_idx) ? m_bank_addr_idx : scope;
+    }
+
+    /**
+     * @brief    Helper function to get the depth of a command to an address, cut short before the first unspecified level
+     * @details
+     * An unspecified (-1) level matches every node, as does every level below the depth.
+     * 
+     */
+    int get_address_depth(int command, const AddrHierarchy_t& addr_h) {
+      int depth = get_bank_depth(command);
+      for (int level = 1; level <= depth; level++) {
+        if (addr_h[level] == -1) {
+          return level - 1;
+        }
+      }
+      return depth;
+    }
+    /**
+     * @brief    Helper function to add (delta = 1) or remove (delta = -1) a request of the active buffer to/from the counters
+     * @details
+     * 
+     */
+    void update_active_counts(const Request& req, int delta) {
+      int depth = get_address_depth(req.final_command, req.addr_h);
+      int flat_id = 0;
+      m_active_counts[0][0] += delta;
+      for (int level = 1; level <= depth; level++) {
+        flat_id = flat_id * m_dram->m_organization.count[level] + req.addr_h[level];
+        m_active_counts[level][flat_id] += delta;
+      }
+      m_active_depth_counts[depth][flat_id] += delta;
+      m_buffer_version++;
+    }
+    /**
+     * @brief    Helper function to check if a request of the active buffer operates on (a part of) a rank
+     * @details
+     * The ranks are directly below the channel, so a request whose depth is the channel operates on every rank.
+     * 
+     */
+    bool is_rank_active(int rank_id) {
+      if (m_rank_addr_idx == -1) {
+        return m_active_counts[0][0] > 0;
+      }
+      return m_active_depth_counts[0][0] > 0 || m_active_counts[m_rank_addr_idx][rank_id] > 0;
+    }
+    /**
+     * @brief    Helper function to get the rank of an address (m_num_ranks if it does not specify one)
+     * @details
+     * Requests that do not specify a rank (or devices without ranks) are taken as targeting every rank.
+     */
+    int get_rank_slot(const AddrHierarchy_t& addr_h) {
+      if (m_rank_addr_idx == -1 || addr_h[m_rank_addr_idx] == -1) {
+        return m_num_ranks;
+      }
+      return addr_h[m_rank_addr_idx];
+    }
+    /**
+     * @brief    Helper function to add (delta = 1) or remove (delta = -1) a request of the RD/WR or AiM bank buffers to/from the per-rank counters
+     * @details
+     * 
+     */
+    void update_rank_counts(const Request& req, ReqBuffer* buffer, int delta) {
+      int rank_slot = get_rank_slot(req.addr_h);
+      m_rank_buffered_counts[rank_slot] += delta;
+      m_buffer_version++;
+      if (buffer == &m_aim_bank_buffer) {
+        m_rank_aim_counts[rank_slot] += delta;
+        return;
+      }
+      uint64_t key = req.final_command;
+      for (int level = 1; level <= m_row_addr_idx; level++) {
+        key = key * (m_dram->m_organization.count[level] + 1) + (req.addr_h[level] + 1);
+      }
+      auto [group_it, is_new] = m_host_row_groups.try_emplace(key, HostRowGroup{req.final_command, req.addr_h, 0});
+      group_it->second.count += delta;
+      if (group_it->second.count == 0) {
+        m_host_row_groups.erase(group_it);
+        m_host_row_groups_version++;
+      } else if (is_new) {
+        m_host_row_groups_version++;
+      }
+    }
+    /**
+     * @brief    Helper function to find which ranks are at a row boundary
+     * @details
+     * Only recomputes them if the node states of the channel or the buffers have changed since the last time,
+     * so that the refresh manager and get_next_event_clk() share the result within a cycle. The host row groups are
+     * only checked against the device again if the node states or the set of groups have changed.
+     * 
+     */
+    void update_row_boundaries() {
+      int64_t state_version = m_dram->get_state_version(m_channel_id);
+      if (state_version == m_row_boundary_state_version && m_buffer_version == m_row_boundary_buffer_version) {
+        return;
+      }
+      if (state_version != m_row_boundary_state_version || m_host_row_groups_version != m_row_boundary_groups_version) {
+        std::fill(m_rank_host_row_hits.begin(), m_rank_host_row_hits.end(), 0);
+        for (const auto& [key, group] : m_host_row_groups) {
+          if (m_dram->get_preq_command(group.command, group.addr_h) == group.command) {
+            m_rank_host_row_hits[get_rank_slot(group.addr_h)]++;
+          }
+        }
+        m_row_boundary_groups_version = m_host_row_groups_version;
+      }
+      m_row_boundary_state_version = state_version;
+      m_row_boundary_buffer_version = m_buffer_version;
+
+      int num_unresolved = 0;
+      for (int rank_id = 0; rank_id < m_num_ranks; rank_id++) {
+        // The requests in the active buffer have opened the rows they are about to access,
+        // and RD/WR requests hitting an open row are served first
+        m_is_at_row_boundary[rank_id] = !is_rank_active(rank_id) &&
+                                        m_rank_host_row_hits[rank_id] + m_rank_host_row_hits[m_num_ranks] == 0;
+        m_is_rank_resolved[rank_id] = !m_is_at_row_boundary[rank_id] ||
+                                      m_rank_aim_counts[rank_id] + m_rank_aim_counts[m_num_ranks] == 0;
+        num_unresolved += !m_is_rank_resolved[rank_id];
+      }
+      // A burst keeps working on an open row as long as the next request to the rank hits it.
+      // AiM requests are served in order, so only the oldest one to the rank is the next one.
+      for (auto it = m_aim_bank_buffer.begin(); num_unresolved > 0 && it != m_aim_bank_buffer.end(); it++) {
+        int rank_slot = get_rank_slot(it->addr_h);
+        int first_rank = (rank_slot == m_num_ranks) ? 0 : rank_slot;
+        int last_rank = (rank_slot == m_num_ranks) ? m_num_ranks - 1 : rank_slot;
+        int is_row_hit = -1;
+        for (int rank_id = first_rank; rank_id <= last_rank; rank_id++) {
+          if (m_is_rank_resolved[rank_id]) {
+            continue;
+          }
+          if (is_row_hit == -1) {
+            is_row_hit = m_dram->get_preq_command(it->final_command, it->addr_h) == it->final_command;
+          }
+          m_is_at_row_boundary[rank_id] = !is_row_hit;
+          m_is_rank_resolved[rank_id] = true;
+          num_unresolved--;
+        }
+      }
+    }
+    /**
+     * @brief    Helper function to check if a closing command would close a row that a request in the active buffer needs
+     * @details
+     * A request of the active buffer needs the row if its address matches the one of the command down to
+     * the shallower of their depths.
+     * 
+     */
+    bool is_closing_active_row(int command, const AddrHierarchy_t& addr_h) {
+      int depth = get_address_depth(command, addr_h);
+      int flat_id = 0;
+      for (int level = 0; level < depth; level++) {
+        // The requests whose depth is shallower than the command only need to match down to their own depth
+        if (m_active_depth_counts[level][flat_id] > 0) {
+          return true;
+        }
+        flat_id = flat_id * m_dram->m_organization.count[level + 1] + addr_h[level + 1];
+      }
+      return m_active_counts[depth][flat_id] > 0;
+    }
 
     /**
      * @brief    
@@ -489,77 +936,178 @@ class AiMController final : public IDRAMController, public Implementation {
      * This function is called at the beginning of the tick() function.
      * It checks the pending queue to see if the top request has received data from DRAM.
      * If so, it finishes this request by calling its callback and poping it from the pending queue.
+     * Returns whether any request has been served.
      */
-    void serve_completed_reqs() {
-      // Serve the pending reads
-      if (pending_reads.size()) {
-        // Check the first pending request
-        auto& req = pending_reads.front();
-        if (req.depart <= m_clk) {
-          // Request received data from dram
-          if (req.depart - req.arrive > 1) {
-            // Check if this requests accesses the DRAM or is being forwarded.
-            // TODO add the stats back
-            // s_read_latency += req.depart - req.arrive;
-          }
-
-          if (req.callback) {
-            // If the request comes from outside (e.g., processor), call its callback
+    bool serve_completed_reqs() {
+      bool is_served = false;
+      // Retire every request that has departed, in the order of (depart, issue)
+      while (m_pending_completions.has_due(m_clk)) {
+        Request req = m_pending_completions.pop();
+        if (m_is_latency_histogram_enabled) {
+          record_latencies(req);
+        }
+        if (req.callback) {
+          DEBUG_LOG(AiMController, m_logger, 
+                    "[AiMulator: Ctrl, CH{}] callback request type: {} addr: 0x{:x}", 
+                    m_channel_id, req.type_id, req.addr);
+          // If the request comes from outside (e.g., processor), call its callback
+          if (m_deferred_reqs != nullptr) {
+            m_deferred_reqs->push_back(std::move(req));
+          } else {
             req.callback(req);
           }
-          // Finally, remove this request from the pending queue
-          pending_reads.pop();
         }
+        s_num_completed_reqs++;
+        is_served = true;
       }
-      
-      // Serve the pending writes
-      if (pending_writes.size()) {
-        auto write_req_it = pending_writes.begin();
-        while (write_req_it != pending_writes.end()) {
-          if (write_req_it->depart <= m_clk) {
-            if(write_req_it->callback){
-              write_req_it->callback(*write_req_it);
-            }
-            write_req_it = pending_writes.erase(write_req_it); 
-          }
-          else { ++write_req_it; }
+
+      return is_served;
+    };
+
+    /**
+     * @brief    Records the latencies of a request that has just finished
+     * @details
+     * Queueing: from its acceptance by the memory system (including any staging) to its first command.
+     * Service: from its first command to its data. End-to-end: from its acceptance to its data.
+     * Requests that did not come through the memory system fall back to their arrival at the controller.
+     * Reads forwarded from the write buffer never issue a command and are not recorded.
+     * 
+     */
+    void record_latencies(const Request& req) {
+      if (req.issue == -1 || req.type_id < 0 || req.type_id >= Request::Type::UNKNOWN) {
+        return;
+      }
+      Clk_t accept = (req.accept != -1) ? req.accept : req.arrive;
+      auto& histograms = m_latency_histograms[req.type_id];
+      histograms[LatencyKind::Queueing].record(req.issue - accept);
+      histograms[LatencyKind::Service].record(req.depart - req.issue);
+      histograms[LatencyKind::EndToEnd].record(req.depart - accept);
+    };
+
+    /**
+     * @brief    Adds a request that is about to finish to the completion min-heap
+     * @details
+     * With report_completion_lag, also accounts for how much later the request would have been retired by
+     * the in-order legacy queue it used to go to, which retired at most one request (its head) per cycle.
+     * 
+     */
+    void push_completion(Request&& req, LegacyQueue legacy_queue) {
+      if (m_report_completion_lag && legacy_queue != LegacyQueue::None) {
+        Clk_t& last_retire_clk = m_legacy_retire_clk[static_cast<int>(legacy_queue)];
+        last_retire_clk = std::max(req.depart, last_retire_clk + 1);
+        size_t lag = last_retire_clk - req.depart;
+        if (lag > 0) {
+          s_num_lagged_completions++;
+          s_completion_lag_cycles += lag;
+          s_max_completion_lag_cycles = std::max(s_max_completion_lag_cycles, lag);
         }
       }
-      
-      // Serve the AiM bank commands
-      if (pending_aim_bank.size()) {
-        auto& req = pending_aim_bank.front();
-        DEBUG_LOG(AiMController, m_logger, 
-                  "[AiMulator: Ctrl, CH{} serve_completed_reqs()] pending_aim_bank: type={} addr=0x{:x} depart={} m_clk={} has_callback={}", 
-                  m_channel_id, req.type_id, req.addr, req.depart, m_clk, (req.callback ? 1 : 0));
-        if (req.depart <= m_clk) {
-          if (req.callback) {
-            DEBUG_LOG(AiMController, m_logger, 
-                      "[AiMulator: Ctrl, CH{}] callback request type: {} addr: 0x{:x}", 
-                      m_channel_id, req.command, req.addr);
-            // If the request comes from outside (e.g., processor), call its callback
-            req.callback(req);
-          }
-          // Finally, remove this request from the pending queue
-          pending_aim_bank.pop();
+      m_pending_completions.push(std::move(req));
+    };
+
+    bool has_host_requests() {
+      return m_read_buffer.size() != 0 || m_write_buffer.size() != 0;
+    };
+
+    bool has_pim_requests() {
+      return m_aim_bank_buffer.size() != 0 || m_aim_no_bank_buffer.size() != 0;
+    };
+
+    bool is_switching_mode() {
+      return m_clk < m_mode_switch_done_clk;
+    };
+
+    // The arrival of the oldest request in the buffers of a mode, which are filled in order
+    Clk_t get_oldest_arrive(bool is_pim) {
+      ReqBuffer& buffer1 = is_pim ? m_aim_bank_buffer : m_read_buffer;
+      ReqBuffer& buffer2 = is_pim ? m_aim_no_bank_buffer : m_write_buffer;
+      Clk_t oldest_arrive = m_clk;
+      for (auto buffer : {&buffer1, &buffer2}) {
+        if (buffer->size() != 0) {
+          oldest_arrive = std::min(oldest_arrive, buffer->begin()->arrive);
         }
       }
+      return oldest_arrive;
+    };
 
-      // Serve the AiM no-bank commands
-      if (pending_aim_no_bank.size()) {
-        auto& req = pending_aim_no_bank.front();
-        if (req.depart <= m_clk) {
-          if (req.callback) {
-            DEBUG_LOG(AiMController, m_logger, 
-                      "[AiM Controller] callback request type: {} addr: 0x{:x}", 
-                      req.command, req.addr);
-            // If the request comes from outside (e.g., processor), call its callback
-            req.callback(req);
+    /**
+     * @brief    Checks if we need to switch between the host and PIM modes
+     * @details
+     * A mode whose requests have run out is always left for the other one if it has any. Otherwise, the policy decides:
+     * Watermark: leaves a mode once the buffers of the other one fill up beyond their high watermark.
+     * TimeSlice: leaves a mode once it has been on for its time slice.
+     * Cost: leaves a mode once the requests of the other one have waited for longer (in total) than the switch would
+     *       delay the requests of the current one (in total). A mode is kept at least as long as the switch to it took.
+     * Switching takes mode_switch_latency cycles, in which no request of either mode is scheduled.
+     * 
+     */
+    void set_pim_mode() {
+      bool has_host = has_host_requests();
+      bool has_pim = has_pim_requests();
+      if (m_mode_switch_policy == ModeSwitchPolicy::Exclusive) {
+        m_is_pim_mode = has_pim;
+        return;
+      }
+
+      bool has_current = m_is_pim_mode ? has_pim : has_host;
+      bool has_other = m_is_pim_mode ? has_host : has_pim;
+      bool is_switching = false;
+      if (!has_other) {
+        return;
+      } else if (!has_current) {
+        is_switching = true;
+      } else {
+        switch (m_mode_switch_policy) {
+          case ModeSwitchPolicy::Watermark: {
+            if (m_is_pim_mode) {
+              is_switching = m_read_buffer.size() > m_host_high_watermark * m_read_buffer.max_size ||
+                             m_write_buffer.size() > m_host_high_watermark * m_write_buffer.max_size;
+            } else {
+              is_switching = m_aim_bank_buffer.size() > m_pim_high_watermark * m_aim_bank_buffer.max_size;
+            }
+            break;
+          }
+          case ModeSwitchPolicy::TimeSlice: {
+            is_switching = m_clk - m_mode_start_clk >= (m_is_pim_mode ? m_pim_time_slice : m_host_time_slice);
+            break;
+          }
+          case ModeSwitchPolicy::Cost: {
+            size_t num_current = m_is_pim_mode ? m_aim_bank_buffer.size() + m_aim_no_bank_buffer.size()
+                                               : m_read_buffer.size() + m_write_buffer.size();
+            size_t num_other = m_is_pim_mode ? m_read_buffer.size() + m_write_buffer.size()
+                                             : m_aim_bank_buffer.size() + m_aim_no_bank_buffer.size();
+            // The requests of the other mode have been waiting since the current mode started serving (or since they arrived)
+            Clk_t served_clk = m_clk - m_mode_switch_done_clk;
+            Clk_t waiting_clk = m_clk - std::max(get_oldest_arrive(!m_is_pim_mode), m_mode_switch_done_clk);
+            double waiting_cost = (double) num_other * waiting_clk;
+            double switching_cost = (double) num_current * m_mode_switch_latency;
+            is_switching = served_clk >= m_mode_switch_latency && waiting_cost > m_mode_switch_cost_factor * switching_cost;
+            break;
           }
-          // Finally, remove this request from the pending queue
-          pending_aim_no_bank.pop();
+          default:
+            break;
         }
       }
+
+      if (is_switching) {
+        m_is_pim_mode = !m_is_pim_mode;
+        m_mode_start_clk = m_clk;
+        m_mode_switch_done_clk = m_clk + m_mode_switch_latency;
+        s_num_mode_switches++;
+        DEBUG_LOG(AiMController, m_logger, "[AiMulator: Ctrl, CH{}] Switching to the {} mode at clk={}",
+                  m_channel_id, m_is_pim_mode ? "PIM" : "host", m_clk);
+      }
+    };
+
+    // Accounts the cycles from m_clk - num_cycles + 1 to m_clk to the mode (or the switch) the controller is in
+    void update_mode_stats(Clk_t num_cycles) {
+      if (is_switching_mode()) {
+        s_mode_switch_cycles += num_cycles;
+      } else if (m_is_pim_mode) {
+        s_pim_mode_cycles += num_cycles;
+      } else {
+        s_host_mode_cycles += num_cycles;
+      }
     };
 
     /**
@@ -660,7 +1208,9 @@ class AiMController final : public IDRAMController, public Implementation {
           // For rank-scope priority (e.g., refresh), block if same rank
           // For bankgroup-scope, block if same bankgroup, etc.
           // priority_scope is the level index: 0=channel, 1=rank, 2=bankgroup, 3=bank
-          for (int level = 0; level <= priority_scope; level++) {
+          // A multi-bank AiM request (e.g., MACAB) operates on every bank under its own scope
+          int depth = std::min<int>(priority_scope, get_bank_depth(aim_it->final_command));
+          for (int level = 0; level <= depth; level++) {
             if (aim_it->addr_h[level] != priority_req_it->addr_h[level] &&
                 aim_it->addr_h[level] != -1 && priority_req_it->addr_h[level] != -1) {
               // Different target at a level <= priority_scope, so no conflict
@@ -671,8 +1221,12 @@ class AiMController final : public IDRAMController, public Implementation {
           return false;
         };
 
-        if (!request_found) {
-          if (m_aim_bank_buffer.size() != 0 || m_aim_no_bank_buffer.size() != 0) {
+        // Query the mode switch policy to decide whether the AiM or the RD/WR buffers are served
+        if (!request_found && !is_switching_mode()) {
+          set_pim_mode();
+        }
+        if (!request_found && !is_switching_mode()) {
+          if (m_is_pim_mode) {
             // Try bank buffer first
             if (m_aim_bank_buffer.size() != 0) {
               req_it = m_scheduler->get_best_aim_request(m_aim_bank_buffer);
@@ -732,24 +1286,12 @@ class AiMController final : public IDRAMController, public Implementation {
       // 2.3 If we find a request to schedule, we need to check if it will close an opened row in the active buffer.
       if (request_found) {
         if (m_dram->m_command_meta(req_it->command).is_closing) {
-          // If the command is PRE then check whether any request in the active buffer requires the row open,
-          // by iteration.
-          auto& rowgroup = req_it->addr_h;
-          for (auto _it = m_active_buffer.begin(); _it != m_active_buffer.end(); _it++) {
-            auto& _it_rowgroup = _it->addr_h;
-            bool is_matching = true;
-            for (int i = 0; i < m_bank_addr_idx + 1 ; i++) {
-              if (_it_rowgroup[i] != rowgroup[i] && _it_rowgroup[i] != -1 && rowgroup[i] != -1) {
-                is_matching = false;
-                break;
-              }
-            }
-            if (is_matching) {
-              // The requst requires the opend row before closing.
-              // Reverse the decision.
-              request_found = false;
-              break;
-            }
+          // If the command is PRE then check whether any request in the active buffer requires the row open.
+          // Multi-bank commands (e.g., PREA, MACAB) cover every bank under their scope, whatever the deeper levels of their address are.
+          if (is_closing_active_row(req_it->command, req_it->addr_h)) {
+            // The requst requires the opend row before closing.
+            // Reverse the decision.
+            request_found = false;
           }
         }
       }
@@ -758,7 +1300,6 @@ class AiMController final : public IDRAMController, public Implementation {
     }
 
     void finalize() override {
-      // s_avg_read_latency = (float) s_read_latency / (float) s_num_read_reqs;
       // s_queue_len_avg = (float) s_queue_len / (float) m_clk;
       // s_read_queue_len_avg = (float) s_read_queue_len / (float) m_clk;
       // s_write_queue_len_avg = (float) s_write_queue_len / (float) m_clk;
@@ -773,6 +1314,7 @@ class AiMController final : public IDRAMController, public Implementation {
         "RFMab", "RFMpb", "MACSB", "AFSB", "RDCP", "WRCP",
         "ACT4_BG-1", "ACT4_BG-2", "PRE4_BG",
         "MAC4B_INTRA", "AF4B_INTRA", "EWMUL", "EWADD",
+        "ACT4_BKS-1", "ACT4_BKS-2", "PRE4_BKS", "MAC4B_INTER", "AF4B_INTER",
         "ACT16-1", "ACT16-2", "MACAB", "AFAB", "WRAFLUT", "WRBK",
         "WRGB", "WRMAC", "WRBIAS", "RDMAC", "RDAF"
       };
@@ -781,7 +1323,8 @@ class AiMController final : public IDRAMController, public Implementation {
         "Read", "Write", "MAC_SBK", "AF_SBK", "COPY_BKGB", "COPY_GBBK",
         "MAC_4BK_INTRA_BG", "AF_4BK_INTRA_BG", "EWMUL", "EWADD",
         "MAC_ABK", "AF_ABK", "WR_AFLUT", "WR_BK",
-        "WR_GB", "WR_MAC", "WR_BIAS", "RD_MAC", "RD_AF"
+        "WR_GB", "WR_MAC", "WR_BIAS", "RD_MAC", "RD_AF",
+        "MAC_4BK_INTER_BG", "AF_4BK_INTER_BG"
       };
 
       emitter << YAML::Key << get_ifce_name();
@@ -835,6 +1378,17 @@ class AiMController final : public IDRAMController, public Implementation {
       ordered_keys_cycles.push_back(fmt::format("CH{}_idle_cycles", id));
       ordered_keys_cycles.push_back(fmt::format("CH{}_active_cycles", id));
       ordered_keys_cycles.push_back(fmt::format("CH{}_precharged_cycles", id));
+      if (m_mode_switch_policy != ModeSwitchPolicy::Exclusive) {
+        ordered_keys_cycles.push_back(fmt::format("CH{}_host_mode_cycles", id));
+        ordered_keys_cycles.push_back(fmt::format("CH{}_pim_mode_cycles", id));
+        ordered_keys_cycles.push_back(fmt::format("CH{}_mode_switch_cycles", id));
+        ordered_keys_cycles.push_back(fmt::format("CH{}_num_mode_switches", id));
+      }
+      if (m_report_completion_lag) {
+        ordered_keys_cycles.push_back(fmt::format("CH{}_num_lagged_completions", id));
+        ordered_keys_cycles.push_back(fmt::format("CH{}_completion_lag_cycles", id));
+        ordered_keys_cycles.push_back(fmt::format("CH{}_max_completion_lag_cycles", id));
+      }
 
       for (const auto& key : ordered_keys_cycles) {
         auto it = registry.find(key);
@@ -845,6 +1399,23 @@ class AiMController final : public IDRAMController, public Implementation {
 
       emitter << YAML::EndMap;
 
+      // Latencies
+      if (m_is_latency_histogram_enabled) {
+        emitter << YAML::Key << "Latencies";
+        emitter << YAML::Value;
+        emitter << YAML::BeginMap;
+        for (size_t type = 0; type < m_latency_histograms.size(); type++) {
+          const auto& histograms = m_latency_histograms[type];
+          if (histograms[LatencyKind::EndToEnd].count() == 0) {
+            continue;
+          }
+          histograms[LatencyKind::Queueing].emit_to(emitter, fmt::format("CH{}_{}_queueing_latency", id, str_type_name(type)));
+          histograms[LatencyKind::Service].emit_to(emitter, fmt::format("CH{}_{}_service_latency", id, str_type_name(type)));
+          histograms[LatencyKind::EndToEnd].emit_to(emitter, fmt::format("CH{}_{}_end_to_end_latency", id, str_type_name(type)));
+        }
+        emitter << YAML::EndMap;
+      }
+
       // Print all my children
       for (auto child_impl : m_children) {
         if (child_impl->has_stats()) {
@@ -0,0 +1,104 @@
+#ifndef     RAMULATOR_CONTROLLER_AIM_LATENCY_HISTOGRAM_H
+#define     RAMULATOR_CONTROLLER_AIM_LATENCY_HISTOGRAM_H
+
+#include <bit>
+#include <cmath>
+#include <string>
+#include <vector>
+#include <algorithm>
+
+#include <yaml-cpp/yaml.h>
+
+#include "base/type.h"
+
+namespace Ramulator {
+
+/**
+ * @brief     Log-bucketed histogram of request latencies (in cycles).
+ * @details
+ * Every power of two is split into 2^SUB_BUCKET_BITS linear sub-buckets, so latencies below 2^SUB_BUCKET_BITS
+ * are exact and the others are off by at most 1/2^SUB_BUCKET_BITS. Percentiles are reported as the upper
+ * bound of the bucket they fall into (and never above the maximum recorded latency).
+ *
+ */
+class AiMLatencyHistogram {
+  public:
+    static constexpr int SUB_BUCKET_BITS = 3;
+    static constexpr int NUM_SUB_BUCKETS = 1 << SUB_BUCKET_BITS;
+
+    void record(Clk_t latency) {
+      latency = std::max<Clk_t>(latency, 0);
+      size_t bucket = get_bucket(latency);
+      if (bucket >= m_buckets.size()) {
+        m_buckets.resize(bucket + 1, 0);
+      }
+      m_buckets[bucket]++;
+      m_count++;
+      m_sum += latency;
+      m_max = std::max(m_max, latency);
+    };
+
+    size_t count() const { return m_count; };
+
+    Clk_t get_percentile(double percentile) const {
+      if (m_count == 0) {
+        return 0;
+      }
+      size_t rank = std::max<size_t>(std::ceil(percentile / 100.0 * m_count), 1);
+      size_t num_seen = 0;
+      for (size_t bucket = 0; bucket < m_buckets.size(); bucket++) {
+        num_seen += m_buckets[bucket];
+        if (num_seen >= rank) {
+          return std::min(get_bucket_lower_bound(bucket + 1) - 1, m_max);
+        }
+      }
+      return m_max;
+    };
+
+    void emit_to(YAML::Emitter& emitter, const std::string& name) const {
+      emitter << YAML::Key << name;
+      emitter << YAML::Value << YAML::BeginMap;
+      emitter << YAML::Key << "count" << YAML::Value << m_count;
+      emitter << YAML::Key << "mean" << YAML::Value << (m_count ? (double) m_sum / m_count : 0.0);
+      emitter << YAML::Key << "max" << YAML::Value << m_max;
+      emitter << YAML::Key << "p50" << YAML::Value << get_percentile(50.0);
+      emitter << YAML::Key << "p99" << YAML::Value << get_percentile(99.0);
+      emitter << YAML::Key << "p999" << YAML::Value << get_percentile(99.9);
+      // The non-empty buckets, keyed by their lower bound
+      emitter << YAML::Key << "buckets" << YAML::Value << YAML::Flow << YAML::BeginMap;
+      for (size_t bucket = 0; bucket < m_buckets.size(); bucket++) {
+        if (m_buckets[bucket] != 0) {
+          emitter << YAML::Key << get_bucket_lower_bound(bucket) << YAML::Value << m_buckets[bucket];
+        }
+      }
+      emitter << YAML::EndMap;
+      emitter << YAML::EndMap;
+    };
+
+  private:
+    std::vector<size_t> m_buckets;
+    size_t m_count = 0;
+    Clk_t m_sum = 0;
+    Clk_t m_max = 0;
+
+    static size_t get_bucket(Clk_t latency) {
+      if (latency < NUM_SUB_BUCKETS) {
+        return latency;
+      }
+      int exponent = std::bit_width((uint64_t) latency) - 1;
+      int shift = exponent - SUB_BUCKET_BITS;
+      return (shift + 1) * NUM_SUB_BUCKETS + ((latency >> shift) & (NUM_SUB_BUCKETS - 1));
+    };
+
+    static Clk_t get_bucket_lower_bound(size_t bucket) {
+      if (bucket < NUM_SUB_BUCKETS) {
+        return bucket;
+      }
+      int shift = bucket / NUM_SUB_BUCKETS - 1;
+      return (Clk_t) (NUM_SUB_BUCKETS + bucket % NUM_SUB_BUCKETS) << shift;
+    };
+};
+
+}        // namespace Ramulator
+
+#endif   // RAMULATOR_CONTROLLER_AIM_LATENCY_HISTOGRAM_H
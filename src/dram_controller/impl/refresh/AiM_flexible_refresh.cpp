@@ -0,0 +1,156 @@
+#include <vector>
+
+#include "base/base.h"
+#include "dram_controller/controller.h"
+#include "dram_controller/refresh.h"
+
+namespace Ramulator {
+
+/**
+ * @brief     All-bank refresh that postpones refreshes during row bursts and pulls them in while a rank is idle.
+ * @details
+ * A refresh falls due every nREFI. Instead of sending it right away, it is sent once the controller reports that
+ * the rank is at a row boundary (see IDRAMController::is_rank_at_row_boundary()), so that a burst of MACs to an
+ * open row is not cut by tRFC. At most max_postponed refreshes can be owed; the next one is sent at once.
+ * While a rank is idle, up to max_pulled_in refreshes are sent ahead of time, which later bursts can then skip.
+ * With both limits set to 0, it behaves as AllBank.
+ *
+ */
+class FlexibleAllBankRefresh : public IRefreshManager, public Implementation {
+  RAMULATOR_REGISTER_IMPLEMENTATION(IRefreshManager, FlexibleAllBankRefresh, "FlexibleAllBank", "All-Bank Refresh scheme with postponing and pulling in.")
+  private:
+    Clk_t m_clk = 0;
+    IDRAM* m_dram;
+    IDRAMController* m_ctrl;
+
+    int m_dram_org_levels = -1;
+    int m_rank_level = -1;
+    int m_num_ranks = -1;
+
+    int m_max_postponed = -1;
+    int m_max_pulled_in = -1;
+
+    int m_nrefi = -1;
+    int m_ref_req_id = -1;
+    Clk_t m_next_refresh_cycle = -1;
+
+    // The number of refreshes that are due but not sent yet (negative if refreshes have been pulled in)
+    std::vector<int> m_num_owed;
+    // Whether a refresh has been sent and not issued yet (only one per rank is in the controller at a time)
+    std::vector<bool> m_is_pending;
+
+    size_t s_num_refreshes = 0;
+    std::vector<size_t> s_num_rank_refreshes;
+    size_t s_num_postponed_refreshes = 0;
+    size_t s_num_pulled_in_refreshes = 0;
+    size_t s_num_forced_refreshes = 0;
+
+  public:
+    void init() override {
+      m_ctrl = cast_parent<IDRAMController>();
+
+      m_max_postponed = param<int>("max_postponed").desc("Maximum number of refreshes that can be postponed (8 in JEDEC LPDDR5).").default_val(8);
+      m_max_pulled_in = param<int>("max_pulled_in").desc("Maximum number of refreshes that can be pulled in (8 in JEDEC LPDDR5).").default_val(8);
+      if (m_max_postponed < 0 || m_max_pulled_in < 0) {
+        throw ConfigurationError("FlexibleAllBank: max_postponed ({}) and max_pulled_in ({}) must not be negative!", m_max_postponed, m_max_pulled_in);
+      }
+    };
+
+    void setup(IFrontEnd* frontend, IMemorySystem* memory_system) override {
+      m_dram = m_ctrl->m_dram;
+
+      m_dram_org_levels = m_dram->m_levels.size();
+      m_rank_level = m_dram->m_levels.contains("rank") ? m_dram->m_levels("rank") : -1;
+      m_num_ranks = m_rank_level != -1 ? m_dram->get_level_size("rank") : 1;
+
+      m_nrefi = m_dram->m_timing_vals("nREFI");
+      m_ref_req_id = m_dram->m_requests("all-bank-refresh");
+
+      m_next_refresh_cycle = m_nrefi;
+      m_num_owed.assign(m_num_ranks, 0);
+      m_is_pending.assign(m_num_ranks, false);
+
+      register_stat(s_num_refreshes).name("CH{}_num_refreshes", m_ctrl->m_channel_id);
+      s_num_rank_refreshes.assign(m_num_ranks, 0);
+      for (int r = 0; r < m_num_ranks; r++) {
+        register_stat(s_num_rank_refreshes[r]).name("CH{}_num_refreshes_rank{}", m_ctrl->m_channel_id, r);
+      }
+      register_stat(s_num_postponed_refreshes).name("CH{}_num_postponed_refreshes", m_ctrl->m_channel_id);
+      register_stat(s_num_pulled_in_refreshes).name("CH{}_num_pulled_in_refreshes", m_ctrl->m_channel_id);
+      register_stat(s_num_forced_refreshes).name("CH{}_num_forced_refreshes", m_ctrl->m_channel_id);
+    };
+
+    void tick() {
+      m_clk++;
+
+      if (m_clk == m_next_refresh_cycle) {
+        m_next_refresh_cycle += m_nrefi;
+        for (int r = 0; r < m_num_ranks; r++) {
+          m_num_owed[r]++;
+        }
+      }
+
+      for (int r = 0; r < m_num_ranks; r++) {
+        if (m_is_pending[r]) {
+          continue;
+        }
+        if (m_num_owed[r] > m_max_postponed) {
+          s_num_forced_refreshes++;
+          s_num_postponed_refreshes += is_postponed(r);
+          send_refresh(r);
+        } else if (m_num_owed[r] > 0 && m_ctrl->is_rank_at_row_boundary(r)) {
+          s_num_postponed_refreshes += is_postponed(r);
+          send_refresh(r);
+        } else if (m_num_owed[r] > -m_max_pulled_in && m_ctrl->is_rank_idle(r)) {
+          s_num_pulled_in_refreshes++;
+          send_refresh(r);
+        }
+      }
+    };
+
+    Clk_t get_next_event_clk() override {
+      // The states of the ranks do not change until the controller changes, so whatever is not sent now waits for the next nREFI
+      for (int r = 0; r < m_num_ranks; r++) {
+        if (m_is_pending[r]) {
+          continue;
+        }
+        if (m_num_owed[r] > m_max_postponed ||
+            (m_num_owed[r] > 0 && m_ctrl->is_rank_at_row_boundary(r)) ||
+            (m_num_owed[r] > -m_max_pulled_in && m_ctrl->is_rank_idle(r))) {
+          return m_clk + 1;
+        }
+      }
+      return m_next_refresh_cycle;
+    };
+
+    void fast_forward(Clk_t num_cycles) override {
+      m_clk += num_cycles;
+    };
+
+  private:
+    // Whether the oldest refresh owed to the rank fell due before this cycle
+    bool is_postponed(int rank_id) {
+      return m_num_owed[rank_id] > 1 || m_clk != m_next_refresh_cycle - m_nrefi;
+    };
+
+    void send_refresh(int rank_id) {
+      AddrHierarchy_t addr_h(m_dram_org_levels, -1);
+      addr_h[0] = m_ctrl->m_channel_id;
+      if (m_rank_level != -1) {
+        addr_h[m_rank_level] = rank_id;
+      }
+      Request req(addr_h, m_ref_req_id);
+      req.callback = RequestCallback([this, rank_id](Request&) { m_is_pending[rank_id] = false; });
+
+      bool is_success = m_ctrl->priority_send(req);
+      if (!is_success) {
+        throw std::runtime_error("Failed to send refresh!");
+      }
+      m_num_owed[rank_id]--;
+      m_is_pending[rank_id] = true;
+      s_num_refreshes++;
+      s_num_rank_refreshes[rank_id]++;
+    };
+};
+
+}       // namespace Ramulator
@@ -0,0 +1,152 @@
+#include <vector>
+
+#include "base/base.h"
+#include "dram_controller/controller.h"
+#include "dram_controller/refresh.h"
+
+namespace Ramulator {
+
+/**
+ * @brief     Per-bank refresh scheme.
+ * @details
+ * Refreshes one bank of every rank each nREFI / (number of banks per rank) cycles, in a round-robin order that
+ * visits every bankgroup before moving on to the next bank of a bankgroup. As a per-bank refresh has the bank scope,
+ * the AiM controller keeps serving the AiM requests to the other banks (e.g., single-bank and 4-bank ones to
+ * other bankgroups) while the refresh waits for its bank to be precharged or for tRFCpb.
+ * Only one refresh per bank is in the controller at a time: a refresh falling due while the previous one to its bank
+ * has not been issued yet is owed and sent once that one is issued, instead of piling up behind a busy bank.
+ * Each REFpb refreshes a single bank (LPDDR5 bank-pair refresh is not modeled).
+ *
+ */
+class PerBankRefresh : public IRefreshManager, public Implementation {
+  RAMULATOR_REGISTER_IMPLEMENTATION(IRefreshManager, PerBankRefresh, "PerBank", "Per-Bank Refresh scheme.")
+  private:
+    Clk_t m_clk = 0;
+    IDRAM* m_dram;
+    IDRAMController* m_ctrl;
+
+    int m_dram_org_levels = -1;
+    int m_rank_level = -1;
+    int m_bankgroup_level = -1;
+    int m_bank_level = -1;
+    int m_num_ranks = -1;
+    int m_num_bankgroups = -1;
+    int m_num_banks = -1;
+
+    int m_nrefi_pb = -1;
+    int m_ref_req_id = -1;
+    Clk_t m_next_refresh_cycle = -1;
+    // The (flat) bank of every rank refreshed next
+    int m_next_bank = 0;
+
+    // Per (rank, flat bank): the number of refreshes that are due but not sent yet,
+    // and whether a refresh has been sent and not issued yet
+    std::vector<int> m_num_owed;
+    std::vector<bool> m_is_pending;
+    // The number of banks owed a refresh and without a pending one (i.e., that can be sent right away)
+    int m_num_sendable = 0;
+
+    size_t s_num_refreshes = 0;
+    std::vector<size_t> s_num_rank_refreshes;
+
+  public:
+    void init() override {
+      m_ctrl = cast_parent<IDRAMController>();
+    };
+
+    void setup(IFrontEnd* frontend, IMemorySystem* memory_system) override {
+      m_dram = m_ctrl->m_dram;
+
+      if (!m_dram->m_requests.contains("per-bank-refresh")) {
+        throw ConfigurationError("PerBank: the DRAM does not support per-bank refresh!");
+      }
+
+      m_dram_org_levels = m_dram->m_levels.size();
+      m_rank_level = m_dram->m_levels.contains("rank") ? m_dram->m_levels("rank") : -1;
+      m_bankgroup_level = m_dram->m_levels.contains("bankgroup") ? m_dram->m_levels("bankgroup") : -1;
+      m_bank_level = m_dram->m_levels("bank");
+      m_num_ranks = m_rank_level != -1 ? m_dram->get_level_size("rank") : 1;
+      m_num_bankgroups = m_bankgroup_level != -1 ? m_dram->get_level_size("bankgroup") : 1;
+      m_num_banks = m_dram->get_level_size("bank");
+
+      m_nrefi_pb = std::max(m_dram->m_timing_vals("nREFI") / (m_num_bankgroups * m_num_banks), 1);
+      m_ref_req_id = m_dram->m_requests("per-bank-refresh");
+
+      m_next_refresh_cycle = m_nrefi_pb;
+      m_num_owed.assign(m_num_ranks * m_num_bankgroups * m_num_banks, 0);
+      m_is_pending.assign(m_num_ranks * m_num_bankgroups * m_num_banks, false);
+
+      register_stat(s_num_refreshes).name("CH{}_num_refreshes", m_ctrl->m_channel_id);
+      s_num_rank_refreshes.assign(m_num_ranks, 0);
+      for (int r = 0; r < m_num_ranks; r++) {
+        register_stat(s_num_rank_refreshes[r]).name("CH{}_num_refreshes_rank{}", m_ctrl->m_channel_id, r);
+      }
+    };
+
+    void tick() {
+      m_clk++;
+
+      if (m_clk == m_next_refresh_cycle) {
+        m_next_refresh_cycle += m_nrefi_pb;
+        for (int r = 0; r < m_num_ranks; r++) {
+          int bank_idx = r * m_num_bankgroups * m_num_banks + m_next_bank;
+          m_num_sendable += m_num_owed[bank_idx] == 0 && !m_is_pending[bank_idx];
+          m_num_owed[bank_idx]++;
+        }
+        m_next_bank = (m_next_bank + 1) % (m_num_bankgroups * m_num_banks);
+      }
+
+      if (m_num_sendable == 0) {
+        return;
+      }
+      for (int bank_idx = 0; bank_idx < (int) m_num_owed.size(); bank_idx++) {
+        if (m_num_owed[bank_idx] > 0 && !m_is_pending[bank_idx]) {
+          send_refresh(bank_idx);
+        }
+      }
+    };
+
+    Clk_t get_next_event_clk() override {
+      // Owed refreshes to banks with a pending refresh wait for the controller to issue it
+      return m_num_sendable > 0 ? m_clk + 1 : m_next_refresh_cycle;
+    };
+
+    void fast_forward(Clk_t num_cycles) override {
+      m_clk += num_cycles;
+    };
+
+  private:
+    void send_refresh(int bank_idx) {
+      int num_banks_per_rank = m_num_bankgroups * m_num_banks;
+      int rank_id = bank_idx / num_banks_per_rank;
+      int flat_bank_id = bank_idx % num_banks_per_rank;
+
+      AddrHierarchy_t addr_h(m_dram_org_levels, -1);
+      addr_h[0] = m_ctrl->m_channel_id;
+      if (m_rank_level != -1) {
+        addr_h[m_rank_level] = rank_id;
+      }
+      if (m_bankgroup_level != -1) {
+        addr_h[m_bankgroup_level] = flat_bank_id % m_num_bankgroups;
+      }
+      addr_h[m_bank_level] = flat_bank_id / m_num_bankgroups;
+      Request req(addr_h, m_ref_req_id);
+      req.callback = RequestCallback([this, bank_idx](Request&) {
+        m_is_pending[bank_idx] = false;
+        m_num_sendable += m_num_owed[bank_idx] > 0;
+      });
+
+      bool is_success = m_ctrl->priority_send(req);
+      if (!is_success) {
+        throw std::runtime_error("Failed to send refresh!");
+      }
+      m_num_owed[bank_idx]--;
+      m_is_pending[bank_idx] = true;
+      m_num_sendable--;
+      s_num_refreshes++;
+      s_num_rank_refreshes[rank_id]++;
+    };
+
+};
+
+}       // namespace Ramulator
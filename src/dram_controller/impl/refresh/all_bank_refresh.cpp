@@ -20,6 +20,9 @@ class AllBankRefresh : public IRefreshManager, public Implementation {
     int m_ref_req_id = -1;
     Clk_t m_next_refresh_cycle = -1;
 
+    size_t s_num_refreshes = 0;
+    std::vector<size_t> s_num_rank_refreshes;
+
   public:
     void init() override { 
       m_ctrl = cast_parent<IDRAMController>();
@@ -35,6 +38,12 @@ class AllBankRefresh : public IRefreshManager, public Implementation {
       m_ref_req_id = m_dram->m_requests("all-bank-refresh");
 
       m_next_refresh_cycle = m_nrefi;
+
+      register_stat(s_num_refreshes).name("CH{}_num_refreshes", m_ctrl->m_channel_id);
+      s_num_rank_refreshes.assign(m_num_ranks, 0);
+      for (int r = 0; r < m_num_ranks; r++) {
+        register_stat(s_num_rank_refreshes[r]).name("CH{}_num_refreshes_rank{}", m_ctrl->m_channel_id, r);
+      }
     };
 
     void tick() {
@@ -43,7 +52,7 @@ class AllBankRefresh : public IRefreshManager, public Implementation {
       if (m_clk == m_next_refresh_cycle) {
         m_next_refresh_cycle += m_nrefi;
         for (int r = 0; r < m_num_ranks; r++) {
-          std::vector<int> addr_h(m_dram_org_levels, -1);
+          AddrHierarchy_t addr_h(m_dram_org_levels, -1);
           addr_h[0] = m_ctrl->m_channel_id;
           addr_h[1] = r;
           Request req(addr_h, m_ref_req_id);
@@ -52,10 +61,20 @@ class AllBankRefresh : public IRefreshManager, public Implementation {
           if (!is_success) {
             throw std::runtime_error("Failed to send refresh!");
           }
+          s_num_refreshes++;
+          s_num_rank_refreshes[r]++;
         }
       }
     };
 
+    Clk_t get_next_event_clk() override {
+      return m_next_refresh_cycle;
+    };
+
+    void fast_forward(Clk_t num_cycles) override {
+      m_clk += num_cycles;
+    };
+
 };
 
 }       // namespace Ramulator
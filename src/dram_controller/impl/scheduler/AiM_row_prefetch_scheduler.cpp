@@ -0,0 +1,122 @@
+#include <vector>
+
+#include "base/base.h"
+#include "dram_controller/controller.h"
+#include "dram_controller/scheduler.h"
+#include "dram_controller/impl/scheduler/generic_scheduler.h"
+
+namespace Ramulator {
+
+/**
+ * @brief     FRFCFS with a lookahead that opens (and closes) the rows of upcoming AiM requests early.
+ * @details
+ * FRFCFS only serves the head scope group of the AiM buffer, so the row commands of the requests behind it
+ * wait until the group is drained. When no request of the head scope group is ready, this scheduler looks
+ * ahead in the buffer for a request whose next command is a row command (ACT/PRE) that is ready, and issues it.
+ *
+ * A request only gets its row commands early if no older request in the buffer operates on any of its banks.
+ * As the MAC/AF registers are per bank, the accesses to them are never reordered: the prefetched request stays
+ * in the AiM buffer (see Request::is_row_prefetched) and its MACs are only issued once it reaches the head scope group.
+ * From then on it is served as in FRFCFS, e.g., if a refresh closed its row, the ACT that reopens it moves it to the active buffer.
+ *
+ */
+class RowPrefetch : public FRFCFSBase, public Implementation {
+  RAMULATOR_REGISTER_IMPLEMENTATION(IScheduler, RowPrefetch, "RowPrefetch", "FRFCFS AiM Scheduler with row prefetching.")
+
+  public:
+    void init() override {
+      m_lookahead_depth = param<int>("lookahead_depth").desc("Number of AiM requests behind the head scope group that are looked ahead for row commands.").default_val(16);
+      if (m_lookahead_depth < 0) {
+        throw ConfigurationError("RowPrefetch: lookahead_depth ({}) must not be negative!", m_lookahead_depth);
+      }
+    };
+
+    void setup(IFrontEnd* frontend, IMemorySystem* memory_system) override {
+      m_dram = cast_parent<IDRAMController>()->m_dram;
+      m_bank_level = m_dram->m_levels("bank");
+      m_row_level = m_dram->m_levels("row");
+    };
+
+    ReqBuffer::iterator get_best_aim_request(ReqBuffer& buffer) override {
+      if (buffer.size() == 0) {
+        return buffer.end();
+      }
+
+      prepare_requests(buffer);
+
+      // 1. The head scope group is served as in FRFCFS
+      ReqBuffer::iterator group_end;
+      if (auto best = get_best_head_group_request(buffer, group_end); best != buffer.end() || group_end == buffer.end()) {
+        return best;
+      }
+
+      // 2. Look ahead for a ready row command of a request whose banks no older request operates on
+      m_older_targets.clear();
+      for (auto it = buffer.begin(); it != group_end; it++) {
+        add_older_target(*it);
+      }
+      int num_looked_ahead = 0;
+      for (auto it = group_end; it != buffer.end() && num_looked_ahead < m_lookahead_depth; it++, num_looked_ahead++) {
+        if (is_row_command(it->command) && is_ready(*it) && !overlaps_older_target(*it, get_depth(it->command))) {
+          it->is_row_prefetched = true;
+          return it;
+        }
+        add_older_target(*it);
+      }
+      return buffer.end();
+    }
+
+  private:
+    int m_lookahead_depth = 16;
+    int m_bank_level = -1;
+    int m_row_level = -1;
+
+    // The (address, depth) of the banks the requests ahead of the one being looked at operate on
+    std::vector<std::pair<const AddrHierarchy_t*, int>> m_older_targets;
+
+    // ACTs (including the first step of a two-step ACT, which does not open the row yet) and PREs
+    bool is_row_command(int command) {
+      const auto& meta = m_dram->m_command_meta(command);
+      if (meta.is_accessing || meta.is_refreshing) {
+        return false;
+      }
+      return meta.is_opening || meta.is_closing || m_dram->m_command_addressing_level(command) == m_row_level;
+    };
+
+    // The deepest level of the address that narrows down the banks the command operates on
+    // (e.g., the rank for the all-bank commands and the bank for the single-bank ones, whose scope is below the bank).
+    // The same-bank (inter-bankgroup) commands are conservatively taken as operating on the whole scope.
+    int get_depth(int command) {
+      Level_t scope = m_dram->m_command_action_scope(command);
+      return (scope == -1 || scope > m_bank_level) ? m_bank_level : scope;
+    };
+
+    void add_older_target(const Request& req) {
+      int depth = get_depth(req.final_command);
+      if (!m_older_targets.empty()) {
+        const auto& [last_addr_h, last_depth] = m_older_targets.back();
+        if (last_depth == depth && std::equal(last_addr_h->begin(), last_addr_h->begin() + depth + 1, req.addr_h.begin())) {
+          return;
+        }
+      }
+      m_older_targets.emplace_back(&req.addr_h, depth);
+    };
+
+    bool overlaps_older_target(const Request& req, int depth) {
+      for (const auto& [addr_h, older_depth] : m_older_targets) {
+        bool is_overlapping = true;
+        for (int level = 0; level <= std::min(depth, older_depth); level++) {
+          if ((*addr_h)[level] != req.addr_h[level] && (*addr_h)[level] != -1 && req.addr_h[level] != -1) {
+            is_overlapping = false;
+            break;
+          }
+        }
+        if (is_overlapping) {
+          return true;
+        }
+      }
+      return false;
+    };
+};
+
+}       // namespace Ramulator
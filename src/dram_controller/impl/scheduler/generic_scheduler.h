@@ -0,0 +1,147 @@
+#ifndef     RAMULATOR_CONTROLLER_GENERIC_SCHEDULER_H
+#define     RAMULATOR_CONTROLLER_GENERIC_SCHEDULER_H
+
+#include "base/base.h"
+#include "dram_controller/controller.h"
+#include "dram_controller/scheduler.h"
+
+namespace Ramulator {
+
+/**
+ * @brief     FRFCFS policy shared by the AiM schedulers.
+ * @details
+ * Caches the prerequisite command and the ready cycle of every request against the state/timing versions of its
+ * channel, and serves the head scope group of an AiM buffer. The implementations set m_dram in their setup().
+ *
+ */
+class FRFCFSBase : public IScheduler {
+  public:
+    ReqBuffer::iterator compare(ReqBuffer::iterator req1, ReqBuffer::iterator req2) override {
+      bool ready1 = is_ready(*req1);
+      bool ready2 = is_ready(*req2);
+
+      if (ready1 ^ ready2) {
+        if (ready1) {
+          return req1;
+        } else {
+          return req2;
+        }
+      }
+
+      // Fallback to FCFS
+      if (req1->arrive <= req2->arrive) {
+        return req1;
+      } else {
+        return req2;
+      }
+    }
+
+    ReqBuffer::iterator get_best_request(ReqBuffer& buffer) override {
+      if (buffer.size() == 0) {
+        return buffer.end();
+      }
+
+      prepare_requests(buffer);
+
+      auto candidate = buffer.begin();
+      for (auto next = std::next(buffer.begin(), 1); next != buffer.end(); next++) {
+        candidate = compare(candidate, next);
+      }
+      return candidate;
+    }
+
+  protected:
+    IDRAM* m_dram;
+
+    // The state/timing versions of the channel the requests of the current buffer are addressed to
+    int64_t m_state_version = -1;
+    int64_t m_timing_version = -1;
+
+    // Prepare all requests of a non-empty buffer: get their prerequisite commands
+    void prepare_requests(ReqBuffer& buffer) {
+      update_versions(*buffer.begin());
+      for (auto& req : buffer) {
+        update_preq_command(req);
+      }
+    };
+
+    /**
+     * @brief    Returns the earliest ready request of the head scope group of a prepared, non-empty AiM buffer
+     * @details
+     * The head scope group is the run of requests at the front of the buffer whose commands share the scope of the first one
+     * (only the first one for the channel scope, as every later request operates on the same banks). The order between scope
+     * groups is kept, so the later requests are blocked. group_end is set to the request following the group, or to the end
+     * of the buffer if no later request may get ahead of the group (channel scope).
+     */
+    ReqBuffer::iterator get_best_head_group_request(ReqBuffer& buffer, ReqBuffer::iterator& group_end) {
+      // Get the scope of the first request (establishes the "scope group")
+      auto first_it = buffer.begin();
+      Level_t first_scope = m_dram->m_command_action_scope(first_it->command);
+
+      // Channel scope (level 0) -> strict in-order
+      if (first_scope == 0) {
+        first_it->is_row_prefetched = false;
+        group_end = buffer.end();
+        if (is_ready(*first_it)) {
+          return first_it;
+        }
+        return buffer.end();  // Blocked
+      }
+
+      // For other scopes, find best ready request with same scope
+      ReqBuffer::iterator best = buffer.end();
+      group_end = buffer.end();
+      for (auto it = buffer.begin(); it != buffer.end(); it++) {
+        Level_t it_scope = m_dram->m_command_action_scope(it->command);
+
+        // Block if different scope (must maintain order between scope groups)
+        if (it_scope != first_scope) {
+          group_end = it;
+          break;
+        }
+
+        // Its turn has come, so a row it (re-)opens from now on moves it to the active buffer
+        it->is_row_prefetched = false;
+
+        // Check if this request is ready
+        if (is_ready(*it)) {
+          if (best == buffer.end()) {
+            best = it;
+          } else {
+            // FCFS tiebreaker: pick earlier arrival
+            if (it->arrive < best->arrive) {
+              best = it;
+            }
+          }
+        }
+      }
+      return best;
+    };
+
+    void update_versions(const Request& req) {
+      m_state_version = m_dram->get_state_version(req.addr_h[0]);
+      m_timing_version = m_dram->get_timing_version(req.addr_h[0]);
+    };
+
+    // Only recomputes the prerequisite command if the node states of the channel changed since it was cached
+    void update_preq_command(Request& req) {
+      if (req.preq_version != m_state_version) {
+        req.command = m_dram->get_preq_command(req.final_command, req.addr_h);
+        req.preq_version = m_state_version;
+        req.ready_version = -1;
+      }
+    };
+
+    // Only walks the device tree if the timing of the channel changed since the ready cycle was cached
+    bool is_ready(Request& req) {
+      if (req.ready_version != m_timing_version) {
+        req.ready_clk = m_dram->get_ready_clk(req.command, req.addr_h);
+        req.ready_version = m_timing_version;
+      }
+      return req.ready_clk <= m_dram->get_clk();
+    };
+};
+
+}       // namespace Ramulator
+
+#endif  // RAMULATOR_CONTROLLER_GENERIC_SCHEDULER_H
@@ -14,6 +14,18 @@ class IRefreshManager {
 
   public:
     virtual void tick() = 0;
+
+    /**
+     * @brief    Returns the next cycle at which the refresh manager may send a refresh request.
+     * 
+     */
+    virtual Clk_t get_next_event_clk() = 0;
+
+    /**
+     * @brief    Advances the refresh manager over cycles in which it does nothing.
+     * 
+     */
+    virtual void fast_forward(Clk_t num_cycles) = 0;
 };
 
 }        // namespace Ramulator
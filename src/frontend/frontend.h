@@ -32,6 +32,28 @@ class IFrontEnd : public Clocked<IFrontEnd>, public TopLevel<IFrontEnd> {
 
     virtual bool is_finished() = 0;
 
+    /**
+     * @brief    Whether the frontend only reacts to the memory system
+     * 
+     * @details
+     * A memory-driven frontend does nothing on its own but (re)try sending requests. Ticking it
+     * while the memory system keeps rejecting them has no effect, so the simulation loop can
+     * fast-forward over the cycles in which the memory system does not change.
+     * 
+     */
+    virtual bool is_memory_driven() { return false; };
+
+    /**
+     * @brief    Whether the frontend may send requests from the callbacks of served requests
+     * 
+     * @details
+     * A memory system ticking its channels in parallel calls the callbacks only after every channel has ticked,
+     * so such requests would reach the later channels one cycle later than in a serial tick.
+     * The default is conservative (i.e., it may).
+     * 
+     */
+    virtual bool sends_from_callbacks() { return true; };
+
     virtual void finalize() { 
       for (auto component : m_components) {
         component->finalize();
@@ -30,8 +30,7 @@ class AiMWrapper : public IFrontEnd, public Implementation {
     };
 
     bool receive_external_requests(int req_type_id, Addr_t addr, int source_id, std::function<void(Request&)> callback) {
-      Request req = Request(addr, req_type_id, source_id, callback);
-      return m_memory_system->send(req);
+      return m_memory_system->send(Request(addr, req_type_id, source_id, std::move(callback)));
     };
 
     bool receive_external_aim_requests(int req_type_id, Addr_t addr, std::function<void(Request&)> callback) {
@@ -53,6 +52,8 @@ class AiMWrapper : public IFrontEnd, public Implementation {
         case Request::Type::AF_4BK_INTRA_BG:
         case Request::Type::EWMUL:
         case Request::Type::EWADD:
+        case Request::Type::MAC_4BK_INTER_BG:
+        case Request::Type::AF_4BK_INTER_BG:
           aim_num_banks = 4;
           break;
         case Request::Type::MAC_ABK:
@@ -88,8 +89,7 @@ class AiMWrapper : public IFrontEnd, public Implementation {
           break;
       }
       
-      Request req = Request(is_aim, req_type_id, addr, aim_num_banks, callback);
-      return m_memory_system->send(req);
+      return m_memory_system->send(Request(is_aim, req_type_id, addr, aim_num_banks, std::move(callback)));
     };
 
     void tick() override {};
@@ -0,0 +1,95 @@
+#ifndef     RAMULATOR_FRONTEND_AIM_BINARY_TRACE_H
+#define     RAMULATOR_FRONTEND_AIM_BINARY_TRACE_H
+
+#include <cstdint>
+#include <cstring>
+#include <string>
+#include <fstream>
+
+#include "base/AiM_request.h"
+#include "base/exception.h"
+
+namespace Ramulator {
+
+/**
+ * @brief     Fixed-width binary AiM packet trace.
+ * @details
+ * A little-endian file made of a Header followed by num_records Records. The frontend memory-maps
+ * the file and decodes one record at a time, so loading does not depend on the trace length.
+ * resources/aim_trace_converter.py converts a text AiM packet trace into this format.
+ *
+ */
+namespace AiMBinaryTrace {
+
+inline constexpr char     MAGIC[8] = {'A', 'I', 'M', 'T', 'R', 'A', 'C', 'E'};
+inline constexpr uint32_t VERSION = 1;
+inline constexpr int      MAX_LEVELS = 8;
+
+struct Header {
+  char     magic[8];
+  uint32_t version;
+  uint32_t record_size;
+  uint64_t num_records;
+  // The device organization the trace was generated for (num_levels = 0 if unspecified)
+  uint32_t num_levels;
+  uint32_t reserved;
+  int32_t  level_counts[MAX_LEVELS];
+};
+static_assert(sizeof(Header) == 64, "AiM binary trace header must be 64 bytes!");
+
+struct Record {
+  int64_t  addr;                // R/W and single-bank requests
+  uint32_t row_addr;
+  uint16_t ch_mask;
+  uint16_t rank_addr;
+  uint16_t pch_addr;
+  uint16_t bank_addr_or_mask;
+  uint16_t col_addr;
+  int8_t   type_id;
+  int8_t   aim_num_banks;       // -1 for R/W requests
+};
+static_assert(sizeof(Record) == 24, "AiM binary trace record must be 24 bytes!");
+
+/**
+ * @brief     Checks whether the file starts with the binary trace magic number.
+ *
+ */
+inline bool is_binary_trace(const std::string& file_path_str) {
+  std::ifstream trace_file(file_path_str, std::ios::binary);
+  char magic[sizeof(MAGIC)] = {};
+  trace_file.read(magic, sizeof(magic));
+  return trace_file.gcount() == sizeof(MAGIC) && std::memcmp(magic, MAGIC, sizeof(MAGIC)) == 0;
+}
+
+/**
+ * @brief     Decodes a record into the trace entry used by the frontend.
+ *
+ */
+inline void decode(const Record& record, Trace& trace_entry) {
+  if (record.type_id < 0 || record.type_id >= Request::Type::UNKNOWN) {
+    throw ConfigurationError("Binary trace record has an invalid request type {}!", record.type_id);
+  }
+  switch (record.aim_num_banks) {
+    case -1: case 0: case 1: case 4: case 16: break;
+    default:
+      throw ConfigurationError("Binary trace record has an invalid number of banks {}!", record.aim_num_banks);
+  }
+
+  trace_entry.type_id = record.type_id;
+  trace_entry.aim_num_banks = record.aim_num_banks;
+  trace_entry.is_aim = (record.aim_num_banks != -1);
+  trace_entry.is_inter_bg = Request::is_inter_bg_type(record.type_id);
+  trace_entry.addr = record.addr;
+  trace_entry.ch_mask = record.ch_mask;
+  trace_entry.rank_addr = record.rank_addr;
+  trace_entry.pch_addr = record.pch_addr;
+  trace_entry.bank_addr_or_mask = record.bank_addr_or_mask;
+  trace_entry.row_addr = record.row_addr;
+  trace_entry.col_addr = record.col_addr;
+}
+
+}        // namespace AiMBinaryTrace
+
+}        // namespace Ramulator
+
+#endif   // RAMULATOR_FRONTEND_AIM_BINARY_TRACE_H
@@ -1,11 +1,22 @@
 #include <filesystem>
 #include <iostream>
 #include <fstream>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <exception>
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
 
 #include "frontend/frontend.h"
 #include "base/AiM_request.h"
 #include "base/exception.h"
 #include "addr_mapper/addr_mapper.h"
+#include "memory_system/memory_system.h"
+#include "frontend/impl/memory_trace/AiM_binary_trace.h"
 
 namespace Ramulator {
 
@@ -23,36 +34,69 @@ class AiMPacketTrace : public IFrontEnd, public Implementation {
     void init() override {
       std::string trace_path_str = param<std::string>("path").desc("Path to the read write trace file.").required();
       m_clock_ratio = param<uint>("clock_ratio").required();
+      m_is_streaming = param<bool>("streaming").desc("Read and decode a text trace in chunks on a background thread instead of loading it entirely.").default_val(false);
+      m_is_draining = param<bool>("drain").desc("Keep simulating after the last entry is sent until the memory system has served every request (e.g., when the controller buffers host and AiM requests concurrently).").default_val(false);
+      m_chunk_size = param<size_t>("chunk_size").desc("Number of trace entries per chunk in streaming mode.").default_val(65536);
       m_addr_mapper = create_child_ifce<IAddrMapper>();
       auto existing_logger = Logging::get("AiMPacketTrace");
       if (existing_logger) {
         m_logger = existing_logger;
       } else {
         m_logger = Logging::create_logger("AiMPacketTrace");
-        m_logger->info("Loading trace file {} ...", trace_path_str);
-        init_trace(trace_path_str);
-        m_logger->info("Loaded {} lines.", m_trace.size());
+        if (AiMBinaryTrace::is_binary_trace(trace_path_str)) {
+          m_logger->info("Mapping binary trace file {} ...", trace_path_str);
+          init_binary_trace(trace_path_str);
+          m_logger->info("Mapped {} records.", m_trace_length);
+          // The mapped trace is already paged in on demand
+          m_is_streaming = false;
+        } else if (m_is_streaming) {
+          m_logger->info("Streaming trace file {} in chunks of {} entries ...", trace_path_str, m_chunk_size);
+          init_trace_stream(trace_path_str);
+        } else {
+          m_logger->info("Loading trace file {} ...", trace_path_str);
+          init_trace(trace_path_str);
+          m_logger->info("Loaded {} lines.", m_trace.size());
+        }
+      }
+    };
+
+    void setup(IFrontEnd* frontend, IMemorySystem* memory_system) override {
+      m_dram = memory_system->get_ifce<IDRAM>();
+      if (m_bin_header != nullptr) {
+        check_binary_trace_org();
+      }
+    };
+
+    ~AiMPacketTrace() {
+      stop_trace_stream();
+      if (m_bin_mapping != nullptr) {
+        munmap(m_bin_mapping, m_bin_mapping_size);
       }
     };
 
     // AiMulator trace-based
     void tick() override {
-      if (m_cur_trace_idx >= m_trace.size()) return;
+      if (m_cur_trace_idx >= m_trace_length) return;
 
-      const Trace& t = m_trace[m_cur_trace_idx];
+      const Trace& t = get_trace(m_cur_trace_idx);
       bool request_sent = false;
 
       if (!t.is_aim) {
-        Request rw_req = Request(t.addr, t.type_id);
-        request_sent = m_memory_system->send(rw_req);
+        request_sent = m_memory_system->send(Request(t.addr, t.type_id));
       } else {
-        std::vector<Request> aim_reqs = convert_aim_pkt_trace_to_aim_reqs(t);
-        request_sent = m_memory_system->send(aim_reqs);
+        // A rejected packet is retried with the requests built at its first attempt
+        request_sent = m_memory_system->send(get_pkt_reqs(t));
       }
 
       if (request_sent) {
+        // The accepted requests were moved into the memory system
+        m_aim_reqs.clear();
         m_cur_trace_idx++;
         m_trace_count++;
+        // Swap in the next chunk right away so that is_finished() holds as soon as the last entry is sent
+        if (m_is_streaming && m_cur_trace_idx >= m_trace_length) {
+          fetch_next_chunk();
+        }
       }
 
       // TODO: Handle rejected requests assuming Instruction set register (ISR) FSM
@@ -62,9 +106,16 @@ class AiMPacketTrace : public IFrontEnd, public Implementation {
 
     // TODO: FIXME
     bool is_finished() override {
-      return m_trace_count >= m_trace_length;
+      bool is_sent = m_is_streaming ? m_is_stream_done : m_trace_count >= m_trace_length;
+      return is_sent && (!m_is_draining || m_memory_system->is_idle());
     };
 
+    // A rejected trace entry is simply retried in the next tick
+    bool is_memory_driven() override { return true; };
+
+    // Trace requests carry no callbacks
+    bool sends_from_callbacks() override { return false; };
+
   private:
     IAddrMapper* m_addr_mapper = nullptr;
     std::vector<Trace> m_trace;
@@ -72,6 +123,36 @@ class AiMPacketTrace : public IFrontEnd, public Implementation {
     size_t m_trace_length = 0;
     size_t m_cur_trace_idx = 0;
     size_t m_trace_count = 0;
+
+    // Requests of the AiM packet being issued, expanded once for the trace entry m_expanded_trace_count
+    // and kept for its retries (storage is reused across packets)
+    std::vector<Addr_t> m_aim_req_addrs;
+    std::vector<Request> m_aim_reqs;
+    size_t m_expanded_trace_count = -1;
+
+    // Memory-mapped binary trace (records are decoded one at a time)
+    void* m_bin_mapping = nullptr;
+    size_t m_bin_mapping_size = 0;
+    const AiMBinaryTrace::Header* m_bin_header = nullptr;
+    const AiMBinaryTrace::Record* m_bin_records = nullptr;
+    Trace m_bin_trace;
+
+    // Whether the simulation waits for the memory system to serve the requests sent
+    bool m_is_draining = false;
+
+    // Streaming text trace: m_trace holds the chunk being issued while the reader thread decodes the next one
+    bool m_is_streaming = false;
+    size_t m_chunk_size = 0;
+    std::ifstream m_stream_file;
+    std::thread m_stream_thread;
+    std::mutex m_stream_mutex;
+    std::condition_variable m_stream_cv;
+    std::vector<Trace> m_stream_chunk;
+    bool m_is_stream_chunk_ready = false;
+    bool m_is_stream_eof = false;
+    bool m_is_stream_stopping = false;
+    bool m_is_stream_done = false;
+    std::exception_ptr m_stream_error;
     
     Logger_t m_logger;
   
@@ -88,137 +169,295 @@ class AiMPacketTrace : public IFrontEnd, public Implementation {
 
       std::string line;
       while (std::getline(trace_file, line)) {
-        if (line[0] == '#' || line.empty()){
-          continue; // comment or empty line
+        Trace trace_entry {};
+        if (parse_trace_line(line, trace_entry, file_path_str)) {
+          m_trace.push_back(trace_entry);
         }
+      }
 
-        std::vector<std::string> tokens;
-        tokenize(tokens, line, " ");
-        Trace trace_entry {};
+      trace_file.close();
+      m_trace_length = m_trace.size();
+    };
 
-        if (tokens.empty()) continue;
-
-        if (tokens[0] == "R") {
-          trace_entry.type_id = Request::Type::Read;
-          trace_entry.aim_num_banks = -1;
-        } else if (tokens[0] == "W") {
-          trace_entry.type_id = Request::Type::Write;
-          trace_entry.aim_num_banks = -1;
-        } else if (tokens[0] == "MAC_SBK") {
-          trace_entry.type_id = Request::Type::MAC_SBK;
-          trace_entry.aim_num_banks = 1;
-        } else if (tokens[0] == "AF_SBK") {
-          trace_entry.type_id = Request::Type::AF_SBK;
-          trace_entry.aim_num_banks = 1;
-        } else if (tokens[0] == "COPY_BKGB") {
-          trace_entry.type_id = Request::Type::COPY_BKGB;
-          trace_entry.aim_num_banks = 1;
-        } else if (tokens[0] == "COPY_GBBK") {
-          trace_entry.type_id = Request::Type::COPY_GBBK;
-          trace_entry.aim_num_banks = 1;
-        } else if (tokens[0] == "MAC_4BK_INTRA_BG") {
-          trace_entry.type_id = Request::Type::MAC_4BK_INTRA_BG;
-          trace_entry.aim_num_banks = 4;
-        } else if (tokens[0] == "AF_4BK_INTRA_BG") {
-          trace_entry.type_id = Request::Type::AF_4BK_INTRA_BG;
-          trace_entry.aim_num_banks = 4;
-        } else if (tokens[0] == "EWMUL") {
-          trace_entry.type_id = Request::Type::EWMUL;
-          trace_entry.aim_num_banks = 4;
-        } else if (tokens[0] == "EWADD") {
-          trace_entry.type_id = Request::Type::EWADD;
-          trace_entry.aim_num_banks = 4;
-        } else if (tokens[0] == "MAC_ABK") {
-          trace_entry.type_id = Request::Type::MAC_ABK;
-          trace_entry.aim_num_banks = 16;
-        } else if (tokens[0] == "AF_ABK") {
-          trace_entry.type_id = Request::Type::AF_ABK;
-          trace_entry.aim_num_banks = 16;
-        } else if (tokens[0] == "WR_AFLUT") {
-          trace_entry.type_id = Request::Type::WR_AFLUT;
-          trace_entry.aim_num_banks = 16;
-        } else if (tokens[0] == "WR_BK") {
-          trace_entry.type_id = Request::Type::WR_BK;
-          trace_entry.aim_num_banks = 16;
-        } else if (tokens[0] == "WR_GB") {
-          trace_entry.type_id = Request::Type::WR_GB;
-          trace_entry.aim_num_banks = 0;
-        } else if (tokens[0] == "WR_MAC") {
-          trace_entry.type_id = Request::Type::WR_MAC;
-          trace_entry.aim_num_banks = 0;
-        } else if (tokens[0] == "WR_BIAS") {
-          trace_entry.type_id = Request::Type::WR_BIAS;
-          trace_entry.aim_num_banks = 0;
-        } else if (tokens[0] == "RD_MAC") {
-          trace_entry.type_id = Request::Type::RD_MAC;
-          trace_entry.aim_num_banks = 0;
-        } else if (tokens[0] == "RD_AF") {
-          trace_entry.type_id = Request::Type::RD_AF;
-          trace_entry.aim_num_banks = 0;
-        } else {
-          throw ConfigurationError("Trace {} format invalid!", file_path_str);
-        }
-        // else if (tokens[0] == "MAC_4BK_INTER_BG") {
-        //   trace_entry.type_id = Request::Type::MAC_4BK_INTER_BG;
-        //   trace_entry.aim_num_banks = 4;
-        // } else if (tokens[0] == "AF_4BK_INTER_BG") {
-        //   trace_entry.type_id = Request::Type::AF_4BK_INTER_BG;
-        //   trace_entry.aim_num_banks = 4;
-        // } 
-        
-        switch (trace_entry.aim_num_banks) {
-          case -1:
-            trace_entry.is_aim = false;
-            trace_entry.addr = std::stoll(tokens[1]);
-            break;
-          case 0:
-            trace_entry.is_aim = true;
-            trace_entry.ch_mask = static_cast<uint16_t>(std::stoi(tokens[1]));
-            // trace_entry.reg_id = static_cast<int16_t>(std::stoi(tokens[2]));
-            break;
-          case 1:
-            trace_entry.is_aim = true;
-            trace_entry.ch_mask = static_cast<uint16_t>(std::stoi(tokens[1]));
-            trace_entry.addr = std::stoll(tokens[7]);
-            break;
-          case 4:
-            trace_entry.is_aim = true;
-            trace_entry.ch_mask = static_cast<uint16_t>(std::stoi(tokens[1]));
-            trace_entry.rank_addr = static_cast<uint16_t>(std::stoi(tokens[2]));
-            trace_entry.pch_addr = static_cast<uint16_t>(std::stoi(tokens[3]));
-            trace_entry.bank_addr_or_mask = static_cast<uint16_t>(std::stoi(tokens[4]));
-            trace_entry.row_addr = static_cast<uint32_t>(std::stoi(tokens[5]));
-            trace_entry.col_addr = static_cast<uint16_t>(std::stoi(tokens[6]));
-            break;
-          case 16:
-            trace_entry.is_aim = true;
-            trace_entry.ch_mask = static_cast<uint16_t>(std::stoi(tokens[1]));
-            trace_entry.rank_addr = static_cast<uint16_t>(std::stoi(tokens[2]));
-            trace_entry.pch_addr = static_cast<uint16_t>(std::stoi(tokens[3]));
-            trace_entry.bank_addr_or_mask = static_cast<uint16_t>(std::stoi(tokens[4]));
-            trace_entry.row_addr = static_cast<uint32_t>(std::stoi(tokens[5]));
-            trace_entry.col_addr = static_cast<uint16_t>(std::stoi(tokens[6]));
-            break;
-          default: break;
+    void init_trace_stream(const std::string& file_path_str) {
+      fs::path trace_path(file_path_str);
+      if (!fs::exists(trace_path)) {
+        throw ConfigurationError("Trace {} does not exist!", file_path_str);
+      }
+      if (m_chunk_size == 0) {
+        throw ConfigurationError("AiMPacketTrace: chunk_size must be positive!");
+      }
+      m_stream_file.open(trace_path);
+      if (!m_stream_file.is_open()) {
+        throw ConfigurationError("Trace {} cannot be opened!", file_path_str);
+      }
+
+      m_trace.reserve(m_chunk_size);
+      m_stream_chunk.reserve(m_chunk_size);
+      m_stream_thread = std::thread(&AiMPacketTrace::read_trace_stream, this, file_path_str);
+      fetch_next_chunk();
+    };
+
+    // Runs on the reader thread
+    void read_trace_stream(std::string file_path_str) {
+      std::vector<Trace> chunk;
+      chunk.reserve(m_chunk_size);
+      std::string line;
+      while (true) {
+        chunk.clear();
+        try {
+          while (chunk.size() < m_chunk_size && std::getline(m_stream_file, line)) {
+            Trace trace_entry {};
+            if (parse_trace_line(line, trace_entry, file_path_str)) {
+              chunk.push_back(trace_entry);
+            }
+          }
+        } catch (...) {
+          std::lock_guard<std::mutex> lock(m_stream_mutex);
+          m_stream_error = std::current_exception();
+          m_is_stream_eof = true;
+          m_stream_cv.notify_all();
+          return;
         }
 
-        m_trace.push_back(trace_entry);
+        std::unique_lock<std::mutex> lock(m_stream_mutex);
+        m_stream_cv.wait(lock, [this] { return !m_is_stream_chunk_ready || m_is_stream_stopping; });
+        if (m_is_stream_stopping) {
+          return;
+        }
+        if (chunk.empty()) {
+          m_is_stream_eof = true;
+          m_stream_cv.notify_all();
+          return;
+        }
+        // Hand over the decoded chunk and reuse the buffer it replaces
+        std::swap(m_stream_chunk, chunk);
+        m_is_stream_chunk_ready = true;
+        m_stream_cv.notify_all();
       }
+    };
 
-      trace_file.close();
+    void fetch_next_chunk() {
+      std::unique_lock<std::mutex> lock(m_stream_mutex);
+      m_stream_cv.wait(lock, [this] { return m_is_stream_chunk_ready || m_is_stream_eof; });
+      if (m_stream_error) {
+        std::rethrow_exception(m_stream_error);
+      }
+      if (!m_is_stream_chunk_ready) {
+        m_trace.clear();
+        m_is_stream_done = true;
+      } else {
+        std::swap(m_trace, m_stream_chunk);
+        m_is_stream_chunk_ready = false;
+        m_stream_cv.notify_all();
+      }
+      m_cur_trace_idx = 0;
       m_trace_length = m_trace.size();
     };
 
-    std::vector<Request> convert_aim_pkt_trace_to_aim_reqs(const Trace& t) {
-      // Convert addresses of the trace to that of the request.
-      std::vector<Addr_t> aim_req_addrs = m_addr_mapper->convert_pkt_addr(t);
-      // Initialize the request
-      std::vector<Request> aim_reqs(aim_req_addrs.size(), Request(t.is_aim, t.type_id, t.aim_num_banks));
-      // Copy aim_req and assign address for each
-      for (int i = 0; i < aim_req_addrs.size(); i++) {
-        aim_reqs[i].addr = aim_req_addrs[i];
+    void stop_trace_stream() {
+      if (!m_stream_thread.joinable()) {
+        return;
+      }
+      {
+        std::lock_guard<std::mutex> lock(m_stream_mutex);
+        m_is_stream_stopping = true;
+      }
+      m_stream_cv.notify_all();
+      m_stream_thread.join();
+    };
+
+    /**
+     * @brief     Parses a line of the text trace. Returns false for comments and empty lines.
+     */
+    bool parse_trace_line(const std::string& line, Trace& trace_entry, const std::string& file_path_str) {
+      if (line[0] == '#' || line.empty()){
+        return false; // comment or empty line
+      }
+
+      std::vector<std::string> tokens;
+      tokenize(tokens, line, " ");
+
+      if (tokens.empty()) return false;
+
+      if (tokens[0] == "R") {
+        trace_entry.type_id = Request::Type::Read;
+        trace_entry.aim_num_banks = -1;
+      } else if (tokens[0] == "W") {
+        trace_entry.type_id = Request::Type::Write;
+        trace_entry.aim_num_banks = -1;
+      } else if (tokens[0] == "MAC_SBK") {
+        trace_entry.type_id = Request::Type::MAC_SBK;
+        trace_entry.aim_num_banks = 1;
+      } else if (tokens[0] == "AF_SBK") {
+        trace_entry.type_id = Request::Type::AF_SBK;
+        trace_entry.aim_num_banks = 1;
+      } else if (tokens[0] == "COPY_BKGB") {
+        trace_entry.type_id = Request::Type::COPY_BKGB;
+        trace_entry.aim_num_banks = 1;
+      } else if (tokens[0] == "COPY_GBBK") {
+        trace_entry.type_id = Request::Type::COPY_GBBK;
+        trace_entry.aim_num_banks = 1;
+      } else if (tokens[0] == "MAC_4BK_INTRA_BG") {
+        trace_entry.type_id = Request::Type::MAC_4BK_INTRA_BG;
+        trace_entry.aim_num_banks = 4;
+      } else if (tokens[0] == "AF_4BK_INTRA_BG") {
+        trace_entry.type_id = Request::Type::AF_4BK_INTRA_BG;
+        trace_entry.aim_num_banks = 4;
+      } else if (tokens[0] == "EWMUL") {
+        trace_entry.type_id = Request::Type::EWMUL;
+        trace_entry.aim_num_banks = 4;
+      } else if (tokens[0] == "EWADD") {
+        trace_entry.type_id = Request::Type::EWADD;
+        trace_entry.aim_num_banks = 4;
+      } else if (tokens[0] == "MAC_4BK_INTER_BG") {
+        trace_entry.type_id = Request::Type::MAC_4BK_INTER_BG;
+        trace_entry.aim_num_banks = 4;
+      } else if (tokens[0] == "AF_4BK_INTER_BG") {
+        trace_entry.type_id = Request::Type::AF_4BK_INTER_BG;
+        trace_entry.aim_num_banks = 4;
+      } else if (tokens[0] == "MAC_ABK") {
+        trace_entry.type_id = Request::Type::MAC_ABK;
+        trace_entry.aim_num_banks = 16;
+      } else if (tokens[0] == "AF_ABK") {
+        trace_entry.type_id = Request::Type::AF_ABK;
+        trace_entry.aim_num_banks = 16;
+      } else if (tokens[0] == "WR_AFLUT") {
+        trace_entry.type_id = Request::Type::WR_AFLUT;
+        trace_entry.aim_num_banks = 16;
+      } else if (tokens[0] == "WR_BK") {
+        trace_entry.type_id = Request::Type::WR_BK;
+        trace_entry.aim_num_banks = 16;
+      } else if (tokens[0] == "WR_GB") {
+        trace_entry.type_id = Request::Type::WR_GB;
+        trace_entry.aim_num_banks = 0;
+      } else if (tokens[0] == "WR_MAC") {
+        trace_entry.type_id = Request::Type::WR_MAC;
+        trace_entry.aim_num_banks = 0;
+      } else if (tokens[0] == "WR_BIAS") {
+        trace_entry.type_id = Request::Type::WR_BIAS;
+        trace_entry.aim_num_banks = 0;
+      } else if (tokens[0] == "RD_MAC") {
+        trace_entry.type_id = Request::Type::RD_MAC;
+        trace_entry.aim_num_banks = 0;
+      } else if (tokens[0] == "RD_AF") {
+        trace_entry.type_id = Request::Type::RD_AF;
+        trace_entry.aim_num_banks = 0;
+      } else {
+        throw ConfigurationError("Trace {} format invalid!", file_path_str);
+      }
+      // The bank field of an inter-bankgroup packet is a mask of the banks it operates on
+      trace_entry.is_inter_bg = Request::is_inter_bg_type(trace_entry.type_id);
+      
+      switch (trace_entry.aim_num_banks) {
+        case -1:
+          trace_entry.is_aim = false;
+          trace_entry.addr = std::stoll(tokens[1]);
+          break;
+        case 0:
+          trace_entry.is_aim = true;
+          trace_entry.ch_mask = static_cast<uint16_t>(std::stoi(tokens[1]));
+          // trace_entry.reg_id = static_cast<int16_t>(std::stoi(tokens[2]));
+          break;
+        case 1:
+          trace_entry.is_aim = true;
+          trace_entry.ch_mask = static_cast<uint16_t>(std::stoi(tokens[1]));
+          trace_entry.addr = std::stoll(tokens[7]);
+          break;
+        case 4:
+          trace_entry.is_aim = true;
+          trace_entry.ch_mask = static_cast<uint16_t>(std::stoi(tokens[1]));
+          trace_entry.rank_addr = static_cast<uint16_t>(std::stoi(tokens[2]));
+          trace_entry.pch_addr = static_cast<uint16_t>(std::stoi(tokens[3]));
+          trace_entry.bank_addr_or_mask = static_cast<uint16_t>(std::stoi(tokens[4]));
+          trace_entry.row_addr = static_cast<uint32_t>(std::stoi(tokens[5]));
+          trace_entry.col_addr = static_cast<uint16_t>(std::stoi(tokens[6]));
+          break;
+        case 16:
+          trace_entry.is_aim = true;
+          trace_entry.ch_mask = static_cast<uint16_t>(std::stoi(tokens[1]));
+          trace_entry.rank_addr = static_cast<uint16_t>(std::stoi(tokens[2]));
+          trace_entry.pch_addr = static_cast<uint16_t>(std::stoi(tokens[3]));
+          trace_entry.bank_addr_or_mask = static_cast<uint16_t>(std::stoi(tokens[4]));
+          trace_entry.row_addr = static_cast<uint32_t>(std::stoi(tokens[5]));
+          trace_entry.col_addr = static_cast<uint16_t>(std::stoi(tokens[6]));
+          break;
+        default: break;
+      }
+
+      return true;
+    };
+
+    void init_binary_trace(const std::string& file_path_str) {
+      int fd = open(file_path_str.c_str(), O_RDONLY);
+      if (fd < 0) {
+        throw ConfigurationError("Trace {} cannot be opened!", file_path_str);
+      }
+      struct stat file_stat;
+      if (fstat(fd, &file_stat) != 0 || file_stat.st_size < (off_t) sizeof(AiMBinaryTrace::Header)) {
+        close(fd);
+        throw ConfigurationError("Trace {} format invalid!", file_path_str);
+      }
+      m_bin_mapping_size = file_stat.st_size;
+      m_bin_mapping = mmap(nullptr, m_bin_mapping_size, PROT_READ, MAP_PRIVATE, fd, 0);
+      close(fd);
+      if (m_bin_mapping == MAP_FAILED) {
+        m_bin_mapping = nullptr;
+        throw ConfigurationError("Trace {} cannot be mapped!", file_path_str);
+      }
+      // Records are consumed in order
+      madvise(m_bin_mapping, m_bin_mapping_size, MADV_SEQUENTIAL);
+
+      m_bin_header = static_cast<const AiMBinaryTrace::Header*>(m_bin_mapping);
+      if (m_bin_header->version != AiMBinaryTrace::VERSION) {
+        throw ConfigurationError("Trace {} has an unsupported version {}!", file_path_str, m_bin_header->version);
+      }
+      if (m_bin_header->record_size != sizeof(AiMBinaryTrace::Record) ||
+          m_bin_header->num_levels > AiMBinaryTrace::MAX_LEVELS ||
+          m_bin_mapping_size != sizeof(AiMBinaryTrace::Header) + m_bin_header->num_records * sizeof(AiMBinaryTrace::Record)) {
+        throw ConfigurationError("Trace {} format invalid!", file_path_str);
+      }
+      m_bin_records = reinterpret_cast<const AiMBinaryTrace::Record*>(m_bin_header + 1);
+      m_trace_length = m_bin_header->num_records;
+    };
+
+    void check_binary_trace_org() {
+      // A trace without an organization is not checked
+      if (m_bin_header->num_levels == 0) {
+        return;
+      }
+      bool is_org_matched = (m_bin_header->num_levels == m_dram->m_organization.count.size());
+      for (uint32_t level = 0; is_org_matched && level < m_bin_header->num_levels; level++) {
+        is_org_matched = (m_bin_header->level_counts[level] == m_dram->m_organization.count[level]);
+      }
+      if (!is_org_matched) {
+        throw ConfigurationError("Binary trace was generated for a different device organization than the configured DRAM!");
+      }
+    };
+
+    const Trace& get_trace(size_t trace_idx) {
+      if (m_bin_records == nullptr) {
+        return m_trace[trace_idx];
+      }
+      AiMBinaryTrace::decode(m_bin_records[trace_idx], m_bin_trace);
+      return m_bin_trace;
+    };
+
+    /**
+     * @brief     Returns the requests of the AiM packet being issued, expanding the packet on its first attempt.
+     */
+    std::vector<Request>& get_pkt_reqs(const Trace& t) {
+      if (m_expanded_trace_count != m_trace_count) {
+        // Create a request for each address the packet is expanded to (reusing the vector's storage)
+        m_addr_mapper->convert_pkt_addr(t, m_aim_req_addrs);
+        m_aim_reqs.clear();
+        for (Addr_t addr : m_aim_req_addrs) {
+          Request& aim_req = m_aim_reqs.emplace_back(t.is_aim, t.type_id, t.aim_num_banks);
+          aim_req.addr = addr;
+        }
+        m_expanded_trace_count = m_trace_count;
       }
-      return aim_reqs;
+      return m_aim_reqs;
     };
 
 };
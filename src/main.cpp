@@ -93,6 +93,10 @@ int main(int argc, char* argv[]) {
 
   int tick_mult = frontend_tick * mem_tick;
 
+  // A memory-driven frontend does nothing while the memory system is quiescent,
+  // so the loop can jump over the memory cycles in which nothing happens.
+  bool is_memory_driven = frontend->is_memory_driven();
+
   for (uint64_t i = 0;; i++) {
     if (((i % tick_mult) % mem_tick) == 0) {
       frontend->tick();
@@ -104,6 +108,9 @@ int main(int argc, char* argv[]) {
 
     if ((i % tick_mult) % frontend_tick == 0) {
       memory_system->tick();
+      if (is_memory_driven) {
+        i += memory_system->fast_forward() * frontend_tick;
+      }
     }
   }
 
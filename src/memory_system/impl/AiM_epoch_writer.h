@@ -0,0 +1,99 @@
+#ifndef     RAMULATOR_MEMORYSYSTEM_AIM_EPOCH_WRITER_H
+#define     RAMULATOR_MEMORYSYSTEM_AIM_EPOCH_WRITER_H
+
+#include <string>
+#include <fstream>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+
+#include "base/exception.h"
+
+namespace Ramulator {
+
+/**
+ * @brief     Buffered writer of the epoch statistics stream.
+ * @details
+ * Text is gathered in a buffer that is handed over to a background thread once it fills up,
+ * so the simulation only waits for the file if the thread falls a whole buffer behind.
+ *
+ */
+class AiMEpochWriter {
+  public:
+    AiMEpochWriter(const std::string& path, size_t buffer_size = 1 << 16) : m_buffer_size(buffer_size) {
+      m_file.open(path);
+      if (!m_file.is_open()) {
+        throw ConfigurationError("Epoch statistics file {} cannot be opened!", path);
+      }
+      m_buffer.reserve(m_buffer_size);
+      m_thread = std::thread(&AiMEpochWriter::writer_loop, this);
+    };
+
+    ~AiMEpochWriter() {
+      close();
+    };
+
+    void write(const std::string& text) {
+      m_buffer += text;
+      if (m_buffer.size() >= m_buffer_size) {
+        hand_over();
+      }
+    };
+
+    // Writes out whatever is buffered and stops the background thread
+    void close() {
+      if (!m_thread.joinable()) {
+        return;
+      }
+      hand_over();
+      {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_is_stopping = true;
+      }
+      m_cv.notify_all();
+      m_thread.join();
+      m_file.close();
+    };
+
+  private:
+    size_t m_buffer_size;
+    std::ofstream m_file;
+    std::string m_buffer;   // Filled by the simulation thread
+    std::string m_pending;  // Handed over to the background thread
+
+    std::thread m_thread;
+    std::mutex m_mutex;
+    std::condition_variable m_cv;
+    bool m_is_stopping = false;
+
+    void hand_over() {
+      if (m_buffer.empty()) {
+        return;
+      }
+      std::unique_lock<std::mutex> lock(m_mutex);
+      m_cv.wait(lock, [this] { return m_pending.empty(); });
+      std::swap(m_pending, m_buffer);
+      m_cv.notify_all();
+    };
+
+    void writer_loop() {
+      std::string chunk;
+      while (true) {
+        {
+          std::unique_lock<std::mutex> lock(m_mutex);
+          m_cv.wait(lock, [this] { return !m_pending.empty() || m_is_stopping; });
+          if (m_pending.empty()) {
+            return;
+          }
+          chunk.clear();
+          std::swap(chunk, m_pending);
+        }
+        m_cv.notify_all();
+        m_file << chunk;
+      }
+    };
+};
+
+}        // namespace Ramulator
+
+#endif   // RAMULATOR_MEMORYSYSTEM_AIM_EPOCH_WRITER_H
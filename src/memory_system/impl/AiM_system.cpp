@@ -1,8 +1,14 @@
+#include <thread>
+#include <barrier>
+#include <memory>
+#include <deque>
+
 #include "memory_system/memory_system.h"
 #include "translation/translation.h"
 #include "dram_controller/controller.h"
 #include "addr_mapper/addr_mapper.h"
 #include "dram/AiM_dram.h"
+#include "memory_system/impl/AiM_epoch_writer.h"
 
 DECLARE_DEBUG_FLAG(AiMSystem)
 
@@ -15,11 +21,34 @@ class AiMSystem final : public IMemorySystem, public Implementation {
 
   public:
     void init() override {
+      m_fast_forward = param<bool>("fast_forward").desc("Skip over the memory cycles in which no state can change while the frontend is stalled on a rejected request (requires a memory-driven frontend).").default_val(false);
+      m_staging_size = param<size_t>("staging_size").desc("Size of the per-channel queues staging the broadcast requests rejected by their controller. A broadcast packet is accepted at once if every target channel has room.").default_val(16);
+      m_epoch_length = param<Clk_t>("epoch_length").desc("Number of memory cycles per epoch of the statistics time series; 0 disables it.").default_val(0);
+      std::string epoch_format = param<std::string>("epoch_format").desc("Format of the statistics time series (csv or jsonl).").default_val("csv");
+      if (m_epoch_length < 0) {
+        throw ConfigurationError("AiMSystem: epoch_length ({}) must not be negative!", m_epoch_length);
+      }
+      if (epoch_format != "csv" && epoch_format != "jsonl") {
+        throw ConfigurationError("AiMSystem: unknown epoch_format ({})!", epoch_format);
+      }
+      m_epoch_path = param<std::string>("epoch_path").desc("Path to the file the statistics time series is written to (aimulator_epochs.<epoch_format> by default).")
+                                                     .optional().value_or("aimulator_epochs." + epoch_format);
+      m_is_epoch_jsonl = epoch_format == "jsonl";
+      m_num_threads = param<int>("num_threads").desc("Number of threads ticking the channel controllers in parallel. Request callbacks are still invoked from the calling thread, in channel order, which requires a frontend that does not send requests from them (e.g., AiMPacketTrace).").default_val(1);
+
       // Create device (a top-level node wrapping all channel nodes)
       m_dram = create_child_ifce<IDRAM>();
       m_addr_mapper = create_child_ifce<IAddrMapper>();
       num_chs = m_dram->get_level_size("channel");
       s_num_reqs = std::vector<std::vector<int>>(num_chs, std::vector<int>(Request::Type::UNKNOWN, 0));
+      m_staging_queues.resize(num_chs);
+      m_broadcast_counts.resize(num_chs, 0);
+      // A packet sends at most one request per bank of a bankgroup (inter-bankgroup commands) to each channel,
+      // and must fit into an empty staging queue or it would be retried forever
+      size_t max_pkt_reqs_per_ch = std::max(m_dram->get_level_size("bank"), 1);
+      if (m_staging_size < max_pkt_reqs_per_ch) {
+        throw ConfigurationError("AiMSystem: staging_size ({}) must be at least the number of requests one packet can send to a channel ({})!", m_staging_size, max_pkt_reqs_per_ch);
+      }
       
       // Create memory controllers
       for (int i = 0; i < num_chs; i++) {
@@ -33,52 +62,154 @@ class AiMSystem final : public IMemorySystem, public Implementation {
         // }
       }
 
+      // Channels never share timing state, so their controllers can be ticked concurrently.
+      // The calling thread ticks the first partition and each worker thread ticks one of the others.
+      // The callbacks of the served requests are then called by the calling thread, as in a serial tick.
+      if (m_num_threads < 1) {
+        throw ConfigurationError("AiMSystem: num_threads ({}) must be at least 1!", m_num_threads);
+      }
+      m_num_threads = std::min<int>(m_num_threads, num_chs);
+      if (m_num_threads > 1) {
+        m_served_reqs.resize(num_chs);
+        for (int i = 0; i < num_chs; i++) {
+          if (!m_controllers[i]->defer_callbacks(&m_served_reqs[i])) {
+            throw ConfigurationError("AiMSystem: the controller does not support num_threads ({}) > 1!", m_num_threads);
+          }
+        }
+        m_tick_start = std::make_unique<std::barrier<>>(m_num_threads);
+        m_tick_done = std::make_unique<std::barrier<>>(m_num_threads);
+        for (int thread_id = 1; thread_id < m_num_threads; thread_id++) {
+          m_workers.emplace_back(&AiMSystem::worker_loop, this, thread_id);
+        }
+      }
+
       auto existing_logger = Logging::get("AiMSystem");
       if (existing_logger) {
         m_logger = existing_logger;
       } else {
         m_logger = Logging::create_logger("AiMSystem");
       }
+      if (m_epoch_length > 0) {
+        m_epoch_writer = std::make_unique<AiMEpochWriter>(m_epoch_path);
+        m_next_epoch_clk = m_epoch_length;
+      }
       DEBUG_LOG(AiMSystem, m_logger, "AiM Memory System initialized!");
     };
 
+    void setup(IFrontEnd* frontend, IMemorySystem* memory_system) override {
+      // Callbacks are called after every channel has ticked, so requests sent from them would not match a serial tick
+      if (m_num_threads > 1 && frontend->sends_from_callbacks()) {
+        throw ConfigurationError("AiMSystem: num_threads ({}) > 1 is not supported for frontends sending requests from callbacks!", m_num_threads);
+      }
+    };
+
     bool send(Request req) override {
+      req.accept = m_clk;
       m_addr_mapper->apply(req);
       int ch_id = req.addr_h[0];
       DEBUG_LOG(AiMSystem, m_logger,
                 "[AiMulator: MemSystem] channel_id = {}",
                 ch_id);
+      int type_id = req.type_id;
+      // A single-channel request is never staged, so that its controller applies its own backpressure
       bool is_success = m_controllers[ch_id]->send(req);
-      s_num_reqs[ch_id][req.type_id]++;
+      if (is_success) {
+        s_num_reqs[ch_id][type_id]++;
+        m_is_req_accepted = true;
+        m_is_req_rejected = false;
+      } else {
+        m_is_req_rejected = true;
+      }
       DEBUG_LOG(AiMSystem, m_logger,
                 "[AiMulator: MemSystem] is send() success? = {}",
                 is_success);
       return is_success;
     };
 
-    bool send(std::vector<Request> req_vec) override {
-      // send requests within the req_vec to each channel
-      std::vector<bool> is_success(req_vec.size(), false);
-      bool is_all_success = true;
-      for (int i = 0; i < req_vec.size(); i++) {
-        m_addr_mapper->apply(req_vec[i]);
-        int ch_id = req_vec[i].addr_h[0];
-        is_success[i] = m_controllers[ch_id]->send(req_vec[i]);
-        if (is_success[i]) { s_num_reqs[ch_id][req_vec[i].type_id]++; }
-        // else {
-        //   aim_reqs_waiting_queue =
-        // }
-        is_all_success &= is_success[i];
-      }
-      return is_all_success;
+    bool send(std::span<Request> reqs) override {
+      return send_broadcast(reqs);
     };
     
+    ~AiMSystem() {
+      stop_workers();
+    };
+
+    void finalize() override {
+      stop_workers();
+      close_epochs();
+      IMemorySystem::finalize();
+    };
+
+    void finalize_wrapper(const char* stats_dir, const char* timestamp) override {
+      stop_workers();
+      close_epochs();
+      IMemorySystem::finalize_wrapper(stats_dir, timestamp);
+    };
+
     void tick() override {
       m_clk++;
+      // Staged requests enter their controllers at the same point as requests sent by the frontend
+      drain_staging_queues();
+      // Future actions of all channels are executed before any controller ticks
       m_dram->tick();
+      if (m_num_threads > 1) {
+        m_tick_start->arrive_and_wait();
+        tick_controllers(0);
+        m_tick_done->arrive_and_wait();
+        call_served_callbacks();
+      } else {
+        for (auto controller : m_controllers) {
+          controller->tick();
+        }
+      }
+
+      if (m_clk == m_next_epoch_clk) {
+        sample_epoch();
+        m_next_epoch_clk += m_epoch_length;
+      }
+
+      // Only a frontend whose request was rejected in this memory cycle (and that has nothing else to send) is stalled
+      // until the memory system changes its state. A frontend that did not tick or moved on to new requests is not.
+      m_is_quiescent = m_is_req_rejected && !m_is_req_accepted;
+      m_is_req_accepted = false;
+      m_is_req_rejected = false;
+    };
+
+    Clk_t fast_forward() override {
+      if (!m_fast_forward || !m_is_quiescent) {
+        return 0;
+      }
+
+      // Find the earliest cycle at which anything can happen in the device or any of the controllers
+      Clk_t next_event_clk = m_dram->get_next_event_clk();
       for (auto controller : m_controllers) {
-        controller->tick();
+        next_event_clk = std::min(next_event_clk, controller->get_next_event_clk());
+        if (next_event_clk <= m_clk + 1) {
+          return 0;
+        }
+      }
+      // An epoch is sampled in the tick it ends at
+      next_event_clk = std::min(next_event_clk, m_next_epoch_clk);
+      if (next_event_clk == std::numeric_limits<Clk_t>::max()) {
+        return 0;
+      }
+
+      Clk_t num_cycles = next_event_clk - m_clk - 1;
+      m_clk += num_cycles;
+      m_dram->fast_forward(num_cycles);
+      for (auto controller : m_controllers) {
+        controller->fast_forward(num_cycles);
       }
+      return num_cycles;
+    };
+
+    bool is_idle() override {
+      for (int ch_id = 0; ch_id < num_chs; ch_id++) {
+        if (!m_staging_queues[ch_id].empty() || !m_controllers[ch_id]->is_idle()) {
+          return false;
+        }
+      }
+      return true;
     };
 
     float get_tCK() override {
@@ -90,7 +221,8 @@ class AiMSystem final : public IMemorySystem, public Implementation {
         "Read", "Write", "MAC_SBK", "AF_SBK", "COPY_BKGB", "COPY_GBBK",
         "MAC_4BK_INTRA_BG", "AF_4BK_INTRA_BG", "EWMUL", "EWADD",
         "MAC_ABK", "AF_ABK", "WR_AFLUT", "WR_BK",
-        "WR_GB", "WR_MAC", "WR_BIAS", "RD_MAC", "RD_AF"
+        "WR_GB", "WR_MAC", "WR_BIAS", "RD_MAC", "RD_AF",
+        "MAC_4BK_INTER_BG", "AF_4BK_INTER_BG"
       };
 
       emitter << YAML::Key << "AiMSystem_Stats";
@@ -133,16 +265,188 @@ class AiMSystem final : public IMemorySystem, public Implementation {
     
   protected:
     Clk_t m_clk = 0;
+    // Event-driven fast-forwarding
+    bool m_fast_forward = false;
+    bool m_is_quiescent = false;
+    bool m_is_req_accepted = false;
+    bool m_is_req_rejected = false;
     IDRAM* m_dram;
     uint16_t num_chs;
     IAddrMapper* m_addr_mapper;
     std::vector<IDRAMController*> m_controllers;
     Logger_t m_logger;
     std::queue<Request> request_queue;
-    std::queue<Request> aim_reqs_waiting_queue;
+    // Per-channel staging of accepted requests not yet taken by their controller
+    size_t m_staging_size = 0;
+    std::vector<std::deque<Request>> m_staging_queues;
+    std::vector<size_t> m_broadcast_counts;
     std::vector<std::vector<int>> s_num_reqs;
     int AiM_req_id = 0;
     int stalled_AiM_requests = 0;
     std::function<void(Request &)> callback;
+    // Parallel controller ticking
+    int m_num_threads = 1;
+    bool m_is_stopping = false;
+    std::vector<std::thread> m_workers;
+    std::unique_ptr<std::barrier<>> m_tick_start;
+    std::unique_ptr<std::barrier<>> m_tick_done;
+    std::vector<std::vector<Request>> m_served_reqs;
+    // Statistics time series (sampled at the end of every epoch)
+    Clk_t m_epoch_length = 0;
+    Clk_t m_next_epoch_clk = std::numeric_limits<Clk_t>::max();
+    Clk_t m_last_epoch_clk = 0;
+    std::string m_epoch_path;
+    bool m_is_epoch_jsonl = false;
+    std::vector<std::string> m_epoch_stat_names;
+    std::vector<int64_t> m_epoch_stat_values;
+    std::unique_ptr<AiMEpochWriter> m_epoch_writer;
+
+  private:
+    // Sends the request to its controller, or stages it if the controller rejects it or earlier requests are still staged
+    bool send_or_stage(int ch_id, Request& req) {
+      auto& staging_queue = m_staging_queues[ch_id];
+      if (staging_queue.empty() && m_controllers[ch_id]->send(req)) {
+        return true;
+      }
+      if (staging_queue.size() >= m_staging_size) {
+        return false;
+      }
+      staging_queue.push_back(std::move(req));
+      return true;
+    };
+
+    bool send_broadcast(std::span<Request> reqs) {
+      // The packet is accepted as a whole only if every target channel can take all of its requests
+      // (e.g., one per bank of an inter-bankgroup command), so that no channel ever receives it twice
+      for (auto& req : reqs) {
+        m_addr_mapper->apply(req);
+        m_broadcast_counts[req.addr_h[0]]++;
+      }
+      bool is_fitting = true;
+      for (int ch_id = 0; ch_id < num_chs; ch_id++) {
+        if (m_staging_queues[ch_id].size() + m_broadcast_counts[ch_id] > m_staging_size) {
+          is_fitting = false;
+        }
+        m_broadcast_counts[ch_id] = 0;
+      }
+      if (!is_fitting) {
+        m_is_req_rejected = true;
+        return false;
+      }
+      for (auto& req : reqs) {
+        int ch_id = req.addr_h[0];
+        req.accept = m_clk;
+        s_num_reqs[ch_id][req.type_id]++;
+        if (!send_or_stage(ch_id, req)) {
+          throw std::runtime_error(fmt::format("AiMSystem: channel {} has no staging room left for an accepted broadcast request!", ch_id));
+        }
+      }
+      m_is_req_accepted = true;
+      m_is_req_rejected = false;
+      return true;
+    };
+
+    void drain_staging_queues() {
+      for (int ch_id = 0; ch_id < num_chs; ch_id++) {
+        auto& staging_queue = m_staging_queues[ch_id];
+        while (!staging_queue.empty() && m_controllers[ch_id]->send(staging_queue.front())) {
+          staging_queue.pop_front();
+          m_is_req_accepted = true;
+        }
+      }
+    };
+
+    void tick_controllers(int thread_id) {
+      int begin = thread_id * num_chs / m_num_threads;
+      int end = (thread_id + 1) * num_chs / m_num_threads;
+      for (int i = begin; i < end; i++) {
+        m_controllers[i]->tick();
+      }
+    };
+
+    // Calls the callbacks of the requests served in this tick, in the order a serial tick calls them
+    void call_served_callbacks() {
+      for (auto& served_reqs : m_served_reqs) {
+        for (auto& req : served_reqs) {
+          req.callback(req);
+        }
+        served_reqs.clear();
+      }
+    };
+
+    void worker_loop(int thread_id) {
+      while (true) {
+        m_tick_start->arrive_and_wait();
+        if (m_is_stopping) {
+          return;
+        }
+        tick_controllers(thread_id);
+        m_tick_done->arrive_and_wait();
+      }
+    };
+
+    // Writes one line (record) per channel with the epoch statistics of its controller
+    void sample_epoch() {
+      if (m_epoch_stat_names.empty()) {
+        m_epoch_stat_names = m_controllers[0]->get_epoch_stat_names();
+        if (!m_is_epoch_jsonl) {
+          std::string header = "clk,channel";
+          for (const auto& name : m_epoch_stat_names) {
+            header += "," + name;
+          }
+          m_epoch_writer->write(header + "\n");
+        }
+      }
+
+      std::string line;
+      for (int ch_id = 0; ch_id < num_chs; ch_id++) {
+        m_epoch_stat_values.clear();
+        m_controllers[ch_id]->sample_epoch_stats(m_epoch_stat_values);
+        if (m_is_epoch_jsonl) {
+          line = fmt::format("{{\"clk\": {}, \"channel\": {}", m_clk, ch_id);
+          for (size_t i = 0; i < m_epoch_stat_values.size(); i++) {
+            line += fmt::format(", \"{}\": {}", m_epoch_stat_names[i], m_epoch_stat_values[i]);
+          }
+          line += "}\n";
+        } else {
+          line = fmt::format("{},{}", m_clk, ch_id);
+          for (const auto value : m_epoch_stat_values) {
+            line += fmt::format(",{}", value);
+          }
+          line += "\n";
+        }
+        m_epoch_writer->write(line);
+      }
+      m_last_epoch_clk = m_clk;
+    };
+
+    // Samples the last (partial) epoch and writes out the time series
+    void close_epochs() {
+      if (m_epoch_writer == nullptr) {
+        return;
+      }
+      if (m_clk != m_last_epoch_clk) {
+        sample_epoch();
+      }
+      m_epoch_writer->close();
+      m_epoch_writer.reset();
+    };
+
+    void stop_workers() {
+      if (m_workers.empty()) {
+        return;
+      }
+      // The start barrier publishes m_is_stopping to the workers
+      m_is_stopping = true;
+      m_tick_start->arrive_and_wait();
+      for (auto& worker : m_workers) {
+        worker.join();
+      }
+      m_workers.clear();
+      m_num_threads = 1;
+      for (auto controller : m_controllers) {
+        controller->defer_callbacks(nullptr);
+      }
+    };
 };
 }   // namespace Ramulator
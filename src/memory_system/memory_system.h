@@ -3,6 +3,7 @@
 
 #include <map>
 #include <vector>
+#include <span>
 #include <string>
 #include <functional>
 
@@ -82,7 +83,11 @@ class IMemorySystem : public TopLevel<IMemorySystem> {
      * @return   false    Request is rejected by the memory system, maybe the memory controller is full?
      */
     virtual bool send(Request req) = 0;
-    virtual bool send(std::vector<Request> req_vec) = 0;
+    /**
+     * @brief         Tries to send all requests of an AiM packet. The requests are moved from only if accepted.
+     * 
+     */
+    virtual bool send(std::span<Request> reqs) = 0;
 
     /**
      * @brief         Ticks the memory system
@@ -90,6 +95,22 @@ class IMemorySystem : public TopLevel<IMemorySystem> {
      */
     virtual void tick() = 0;
 
+    /**
+     * @brief         Skips over the upcoming memory cycles in which no state can change
+     * 
+     * @details
+     * Called right after tick() when the frontend is memory-driven. Returns the number of
+     * skipped memory cycles (zero if fast-forwarding is not supported or not possible).
+     * 
+     */
+    virtual Clk_t fast_forward() { return 0; };
+
+    /**
+     * @brief         Returns whether every request sent to the memory system has been served
+     * 
+     */
+    virtual bool is_idle() { return true; };
+
     /**
      * @brief    Returns 
      * 
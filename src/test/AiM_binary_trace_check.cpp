@@ -0,0 +1,93 @@
+#include <algorithm>
+#include <filesystem>
+#include <fstream>
+#include <string>
+
+#include "frontend/impl/memory_trace/AiM_binary_trace.h"
+#include "test/AiM_check.h"
+
+using namespace Ramulator;
+
+static AiMBinaryTrace::Record make_record(int8_t type_id, int8_t aim_num_banks) {
+  AiMBinaryTrace::Record record = {};
+  record.addr = 0x1234;
+  record.row_addr = 70000;
+  record.ch_mask = 0xFFFF;
+  record.rank_addr = 1;
+  record.pch_addr = 0;
+  record.bank_addr_or_mask = 0x1111;
+  record.col_addr = 31;
+  record.type_id = type_id;
+  record.aim_num_banks = aim_num_banks;
+  return record;
+}
+
+static void check_decode() {
+  Trace trace;
+  AiMBinaryTrace::decode(make_record(Request::Type::Read, -1), trace);
+  CHECK(trace.type_id == Request::Type::Read);
+  CHECK(!trace.is_aim);
+  CHECK(!trace.is_inter_bg);
+  CHECK(trace.addr == 0x1234);
+
+  AiMBinaryTrace::decode(make_record(Request::Type::MAC_4BK_INTER_BG, 4), trace);
+  CHECK(trace.type_id == Request::Type::MAC_4BK_INTER_BG);
+  CHECK(trace.is_aim);
+  CHECK(trace.is_inter_bg);
+  CHECK(trace.aim_num_banks == 4);
+  CHECK(trace.row_addr == 70000);
+  CHECK(trace.ch_mask == 0xFFFF);
+  CHECK(trace.rank_addr == 1);
+  CHECK(trace.bank_addr_or_mask == 0x1111);
+  CHECK(trace.col_addr == 31);
+
+  AiMBinaryTrace::decode(make_record(Request::Type::MAC_ABK, 16), trace);
+  CHECK(trace.is_aim);
+  CHECK(!trace.is_inter_bg);
+}
+
+// Records with a request type or a number of banks the frontend does not know are rejected
+static void check_decode_validation() {
+  Trace trace;
+  CHECK_THROWS(AiMBinaryTrace::decode(make_record(-1, -1), trace), ConfigurationError);
+  CHECK_THROWS(AiMBinaryTrace::decode(make_record(Request::Type::UNKNOWN, -1), trace), ConfigurationError);
+  CHECK_THROWS(AiMBinaryTrace::decode(make_record(100, -1), trace), ConfigurationError);
+  for (int8_t aim_num_banks : {-2, 2, 3, 8, 15, 17, 127}) {
+    CHECK_THROWS(AiMBinaryTrace::decode(make_record(Request::Type::MAC_SBK, aim_num_banks), trace), ConfigurationError);
+  }
+  for (int8_t aim_num_banks : {-1, 0, 1, 4, 16}) {
+    AiMBinaryTrace::decode(make_record(Request::Type::MAC_SBK, aim_num_banks), trace);
+    CHECK(trace.aim_num_banks == aim_num_banks);
+  }
+}
+
+static void check_magic() {
+  std::filesystem::path dir = std::filesystem::temp_directory_path();
+  std::string binary_path = (dir / "AiM_binary_trace_check.bin").string();
+  std::string text_path = (dir / "AiM_binary_trace_check.txt").string();
+  std::string short_path = (dir / "AiM_binary_trace_check.short").string();
+
+  AiMBinaryTrace::Header header = {};
+  std::copy(std::begin(AiMBinaryTrace::MAGIC), std::end(AiMBinaryTrace::MAGIC), header.magic);
+  header.version = AiMBinaryTrace::VERSION;
+  header.record_size = sizeof(AiMBinaryTrace::Record);
+  std::ofstream(binary_path, std::ios::binary).write(reinterpret_cast<const char*>(&header), sizeof(header));
+  std::ofstream(text_path) << "MAC_ABK 0xffff 0 0 0 0 0\n";
+  std::ofstream(short_path, std::ios::binary).write(AiMBinaryTrace::MAGIC, 4);
+
+  CHECK(AiMBinaryTrace::is_binary_trace(binary_path));
+  CHECK(!AiMBinaryTrace::is_binary_trace(text_path));
+  CHECK(!AiMBinaryTrace::is_binary_trace(short_path));
+  CHECK(!AiMBinaryTrace::is_binary_trace((dir / "AiM_binary_trace_check.missing").string()));
+
+  std::filesystem::remove(binary_path);
+  std::filesystem::remove(text_path);
+  std::filesystem::remove(short_path);
+}
+
+int main() {
+  check_decode();
+  check_decode_validation();
+  check_magic();
+  return AIM_CHECK_RESULT();
+}
@@ -0,0 +1,46 @@
+#ifndef     RAMULATOR_TEST_AIM_CHECK_H
+#define     RAMULATOR_TEST_AIM_CHECK_H
+
+#include <cstdio>
+
+/**
+ * @brief     Minimal assertions for the AiM component checks run by ctest.
+ * @details
+ * A failed CHECK reports its location and lets the check program go on; AIM_CHECK_RESULT() makes the
+ * program exit with a non-zero status if any CHECK has failed.
+ *
+ */
+namespace Ramulator::AiMCheck {
+
+inline int num_failures = 0;
+
+inline void fail(const char* file, int line, const char* what) {
+  std::fprintf(stderr, "%s:%d: CHECK failed: %s\n", file, line, what);
+  num_failures++;
+}
+
+}        // namespace Ramulator::AiMCheck
+
+#define CHECK(cond)                                                   \
+  do {                                                                \
+    if (!(cond)) {                                                    \
+      Ramulator::AiMCheck::fail(__FILE__, __LINE__, #cond);           \
+    }                                                                 \
+  } while (0)
+
+#define CHECK_THROWS(expr, exception_t)                               \
+  do {                                                                \
+    bool is_thrown = false;                                           \
+    try {                                                             \
+      expr;                                                           \
+    } catch (const exception_t&) {                                    \
+      is_thrown = true;                                               \
+    }                                                                 \
+    if (!is_thrown) {                                                 \
+      Ramulator::AiMCheck::fail(__FILE__, __LINE__, #expr " throws " #exception_t); \
+    }                                                                 \
+  } while (0)
+
+#define AIM_CHECK_RESULT() (Ramulator::AiMCheck::num_failures == 0 ? 0 : 1)
+
+#endif   // RAMULATOR_TEST_AIM_CHECK_H
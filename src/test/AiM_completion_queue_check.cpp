@@ -0,0 +1,77 @@
+#include <vector>
+
+#include "dram_controller/impl/AiM_completion_queue.h"
+#include "test/AiM_check.h"
+
+using namespace Ramulator;
+
+static Request make_req(Addr_t addr, Clk_t depart) {
+  Request req(addr, Request::Type::Read);
+  req.depart = depart;
+  return req;
+}
+
+// Requests are retired by depart cycle, and the ones departing together in push order
+static void check_order() {
+  AiMCompletionQueue queue;
+  CHECK(queue.empty());
+  CHECK(!queue.has_due(1000));
+
+  std::vector<std::pair<Addr_t, Clk_t>> pushed = {{0, 30}, {1, 10}, {2, 20}, {3, 10}, {4, 30}, {5, 5}, {6, 10}};
+  for (auto [addr, depart] : pushed) {
+    queue.push(make_req(addr, depart));
+  }
+  CHECK(queue.size() == pushed.size());
+  CHECK(queue.next_clk() == 5);
+
+  std::vector<Addr_t> retired;
+  for (Clk_t clk = 0; clk <= 30; clk++) {
+    while (queue.has_due(clk)) {
+      Request req = queue.pop();
+      CHECK(req.depart == clk);
+      retired.push_back(req.addr);
+    }
+  }
+  CHECK((retired == std::vector<Addr_t>{5, 1, 3, 6, 2, 0, 4}));
+  CHECK(queue.empty());
+  CHECK(queue.next_clk() == std::numeric_limits<Clk_t>::max());
+}
+
+// A request pushed after others departing at the same cycle were popped still comes after them
+static void check_interleaved_pushes() {
+  AiMCompletionQueue queue;
+  queue.push(make_req(0, 10));
+  queue.push(make_req(1, 10));
+  CHECK(queue.pop().addr == 0);
+  queue.push(make_req(2, 10));
+  queue.push(make_req(3, 8));
+  CHECK(queue.next_clk() == 8);
+  CHECK(!queue.has_due(7));
+  CHECK(queue.pop().addr == 3);
+  CHECK(queue.pop().addr == 1);
+  CHECK(queue.pop().addr == 2);
+}
+
+// Popped requests keep their callbacks
+static void check_callbacks() {
+  AiMCompletionQueue queue;
+  int num_called = 0;
+  Request req(Addr_t(0x40), Request::Type::Read, 0, [&num_called](Request&) { num_called++; });
+  req.depart = 3;
+  queue.push(std::move(req));
+  queue.push(make_req(0x80, 1));
+
+  queue.pop();
+  Request popped = queue.pop();
+  CHECK(popped.addr == 0x40);
+  CHECK(popped.callback);
+  popped.callback(popped);
+  CHECK(num_called == 1);
+}
+
+int main() {
+  check_order();
+  check_interleaved_pushes();
+  check_callbacks();
+  return AIM_CHECK_RESULT();
+}
@@ -0,0 +1,64 @@
+#include <vector>
+
+#include "base/type.h"
+#include "dram/spec.h"
+#include "test/AiM_check.h"
+
+using namespace Ramulator;
+
+// Actions are popped once due, earliest first, and in push order among the ones due at the same cycle
+static void check_order() {
+  FutureActionQueue queue;
+  CHECK(queue.empty());
+  CHECK(queue.next_clk() == std::numeric_limits<Clk_t>::max());
+
+  std::vector<std::pair<Command_t, Clk_t>> pushed = {{0, 12}, {1, 7}, {2, 12}, {3, 3}, {4, 7}, {5, 12}, {6, 9}};
+  for (auto [cmd, clk] : pushed) {
+    queue.push({cmd, AddrHierarchy_t{0, cmd}, clk});
+  }
+  CHECK(queue.size() == pushed.size());
+  CHECK(queue.next_clk() == 3);
+
+  FutureAction action;
+  CHECK(!queue.pop_due(2, action));
+  std::vector<Command_t> popped;
+  for (Clk_t clk = 0; clk <= 12; clk++) {
+    while (queue.pop_due(clk, action)) {
+      CHECK(action.clk == clk);
+      CHECK(action.addr_h[1] == action.cmd);
+      popped.push_back(action.cmd);
+    }
+  }
+  CHECK((popped == std::vector<Command_t>{3, 1, 4, 6, 0, 2, 5}));
+  CHECK(queue.empty());
+}
+
+// Actions overdue by the time the queue is checked (e.g., after a fast-forward) are all popped in order
+static void check_overdue() {
+  FutureActionQueue queue;
+  queue.push({0, AddrHierarchy_t{0}, 20});
+  queue.push({1, AddrHierarchy_t{0}, 10});
+  queue.push({2, AddrHierarchy_t{0}, 10});
+  queue.push({3, AddrHierarchy_t{0}, 50});
+
+  FutureAction action;
+  std::vector<Command_t> popped;
+  while (queue.pop_due(30, action)) {
+    popped.push_back(action.cmd);
+  }
+  CHECK((popped == std::vector<Command_t>{1, 2, 0}));
+  CHECK(queue.size() == 1);
+  CHECK(queue.next_clk() == 50);
+
+  // An action pushed for an earlier cycle than the pending ones is popped first
+  queue.push({4, AddrHierarchy_t{0}, 40});
+  CHECK(queue.next_clk() == 40);
+  CHECK(queue.pop_due(50, action) && action.cmd == 4);
+  CHECK(queue.pop_due(50, action) && action.cmd == 3);
+}
+
+int main() {
+  check_order();
+  check_overdue();
+  return AIM_CHECK_RESULT();
+}
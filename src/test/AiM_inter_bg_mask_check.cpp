@@ -0,0 +1,84 @@
+#include <vector>
+
+#include "addr_mapper/impl/AiM_linear_mapper.h"
+#include "test/AiM_check.h"
+
+using namespace Ramulator;
+
+// Exposes the inter-bankgroup mask handling of the linear mappers on a given organization, without a DRAM
+class InterBgMaskMapper final : public LinearMapperBase {
+  public:
+    InterBgMaskMapper(int bankgroup_bits, int bank_bits) {
+      // Channel, rank, bankgroup, bank, row, column
+      m_addr_bits = {1, 0, bankgroup_bits, bank_bits, 14, 5};
+      m_num_levels = m_addr_bits.size();
+      m_bg_idx = 2;
+      m_ba_idx = 3;
+    };
+
+    using LinearMapperBase::convert_inter_bg_mask;
+    using LinearMapperBase::set_inter_bg_bank_addrs;
+
+    std::vector<int> expand(uint16_t mask) {
+      std::vector<int> bank_ids;
+      convert_inter_bg_mask(mask, bank_ids);
+      return bank_ids;
+    };
+
+    void apply(Request&) override {};
+    void convert_pkt_addr(const Trace&, std::vector<Addr_t>&) override {};
+    IDRAM* get_m_dram() override { return nullptr; };
+};
+
+// 4 bankgroups x 4 banks: the mask has one bit per bank, bankgroup-major
+static void check_expand_4x4() {
+  InterBgMaskMapper mapper(2, 2);
+  CHECK((mapper.expand(0x1111) == std::vector<int>{0}));
+  CHECK((mapper.expand(0x8888) == std::vector<int>{3}));
+  CHECK((mapper.expand(0x5555) == std::vector<int>{0, 2}));
+  CHECK((mapper.expand(0xFFFF) == std::vector<int>{0, 1, 2, 3}));
+
+  // Every selected bank id must be selected in all bankgroups
+  CHECK_THROWS(mapper.expand(0x0001), ConfigurationError);
+  CHECK_THROWS(mapper.expand(0x1110), ConfigurationError);
+  CHECK_THROWS(mapper.expand(0x000F), ConfigurationError);
+  CHECK_THROWS(mapper.expand(0x3111), ConfigurationError);
+  CHECK_THROWS(mapper.expand(0x0000), ConfigurationError);
+}
+
+// 2 bankgroups x 8 banks
+static void check_expand_2x8() {
+  InterBgMaskMapper mapper(1, 3);
+  CHECK((mapper.expand(0x0101) == std::vector<int>{0}));
+  CHECK((mapper.expand(0x8181) == std::vector<int>{0, 7}));
+  CHECK((mapper.expand(0xFFFF) == std::vector<int>{0, 1, 2, 3, 4, 5, 6, 7}));
+  CHECK((mapper.expand(0x1111) == std::vector<int>{0, 4}));
+  CHECK_THROWS(mapper.expand(0x1110), ConfigurationError);
+  CHECK_THROWS(mapper.expand(0x0102), ConfigurationError);
+}
+
+// A mapped inter-bankgroup request operates on its bank in every bankgroup
+static void check_bank_addrs() {
+  InterBgMaskMapper mapper_4x4(2, 2);
+  Request req(true, Request::Type::MAC_4BK_INTER_BG, 4);
+  req.addr_h.resize(mapper_4x4.m_num_levels, 0);
+  for (int bank_id = 0; bank_id < 4; bank_id++) {
+    req.addr_h[mapper_4x4.m_ba_idx] = bank_id;
+    mapper_4x4.set_inter_bg_bank_addrs(req);
+    CHECK(req.inter_bg_bank_addrs == (uint16_t) (0x1111 << bank_id));
+    // The expansion of the mask a request operates on gives back its bank
+    CHECK((mapper_4x4.expand(req.inter_bg_bank_addrs) == std::vector<int>{bank_id}));
+  }
+
+  InterBgMaskMapper mapper_2x8(1, 3);
+  req.addr_h[mapper_2x8.m_ba_idx] = 5;
+  mapper_2x8.set_inter_bg_bank_addrs(req);
+  CHECK(req.inter_bg_bank_addrs == 0x2020);
+}
+
+int main() {
+  check_expand_4x4();
+  check_expand_2x8();
+  check_bank_addrs();
+  return AIM_CHECK_RESULT();
+}
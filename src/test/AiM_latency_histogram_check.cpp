@@ -0,0 +1,93 @@
+#include <yaml-cpp/yaml.h>
+
+#include "dram_controller/impl/AiM_latency_histogram.h"
+#include "test/AiM_check.h"
+
+using namespace Ramulator;
+
+// The latencies below 2^SUB_BUCKET_BITS have their own buckets
+static void check_exact_buckets() {
+  for (Clk_t latency = 0; latency < AiMLatencyHistogram::NUM_SUB_BUCKETS; latency++) {
+    AiMLatencyHistogram h;
+    h.record(latency);
+    h.record(1000);
+    // The smaller latency is the 50th percentile and is reported exactly
+    CHECK(h.get_percentile(50.0) == latency);
+  }
+}
+
+// Above that, a percentile is the upper bound of its bucket, off by at most 1/2^SUB_BUCKET_BITS
+static void check_bucket_bounds() {
+  for (Clk_t latency = AiMLatencyHistogram::NUM_SUB_BUCKETS; latency < (Clk_t) 1 << 40; latency += latency / 7 + 1) {
+    AiMLatencyHistogram h;
+    h.record(latency);
+    h.record((Clk_t) 1 << 41);
+    Clk_t p50 = h.get_percentile(50.0);
+    CHECK(p50 >= latency);
+    CHECK(p50 - latency <= latency / AiMLatencyHistogram::NUM_SUB_BUCKETS);
+  }
+
+  // 16 and 17 share the bucket [16, 17]; 18 starts the next one
+  AiMLatencyHistogram h;
+  h.record(16);
+  h.record(18);
+  h.record(100);
+  CHECK(h.get_percentile(100.0 / 3) == 17);
+  CHECK(h.get_percentile(200.0 / 3) == 19);
+}
+
+static void check_percentiles() {
+  AiMLatencyHistogram empty;
+  CHECK(empty.count() == 0);
+  CHECK(empty.get_percentile(50.0) == 0);
+
+  AiMLatencyHistogram h;
+  for (Clk_t latency = 1; latency <= 100; latency++) {
+    h.record(latency);
+  }
+  CHECK(h.count() == 100);
+  // The 50th latency (50) falls into the bucket [48, 51]
+  CHECK(h.get_percentile(50.0) == 51);
+  // Percentiles never exceed the maximum, even if its bucket extends above it ([96, 103])
+  CHECK(h.get_percentile(99.9) == 100);
+  CHECK(h.get_percentile(100.0) == 100);
+  // Rank 0 is rounded up to the first latency
+  CHECK(h.get_percentile(0.0) == 1);
+
+  // Negative latencies count as 0
+  AiMLatencyHistogram negative;
+  negative.record(-5);
+  CHECK(negative.count() == 1);
+  CHECK(negative.get_percentile(100.0) == 0);
+}
+
+static void check_emit() {
+  AiMLatencyHistogram h;
+  h.record(3);
+  h.record(4);
+  h.record(23);
+
+  YAML::Emitter emitter;
+  emitter << YAML::BeginMap;
+  h.emit_to(emitter, "latency");
+  emitter << YAML::EndMap;
+
+  YAML::Node node = YAML::Load(emitter.c_str())["latency"];
+  CHECK(node["count"].as<size_t>() == 3);
+  CHECK(node["mean"].as<double>() == 10.0);
+  CHECK(node["max"].as<Clk_t>() == 23);
+  CHECK(node["p50"].as<Clk_t>() == 4);
+  // The buckets are keyed by their lower bound: 23 falls into [22, 23]
+  CHECK(node["buckets"].size() == 3);
+  CHECK(node["buckets"][3].as<size_t>() == 1);
+  CHECK(node["buckets"][4].as<size_t>() == 1);
+  CHECK(node["buckets"][22].as<size_t>() == 1);
+}
+
+int main() {
+  check_exact_buckets();
+  check_bucket_bounds();
+  check_percentiles();
+  check_emit();
+  return AIM_CHECK_RESULT();
+}
@@ -0,0 +1,92 @@
+#include <memory>
+#include <vector>
+
+#include "base/AiM_request.h"
+#include "test/AiM_check.h"
+
+using namespace Ramulator;
+
+static std::vector<Addr_t> get_addrs(ReqBuffer& buffer) {
+  std::vector<Addr_t> addrs;
+  for (auto& req : buffer) {
+    addrs.push_back(req.addr);
+  }
+  return addrs;
+}
+
+// The buffer never holds more than max_size requests, and never reallocates its slots
+static void check_capacity() {
+  ReqBuffer buffer;
+  buffer.max_size = 4;
+  for (Addr_t addr = 0; addr < 4; addr++) {
+    CHECK(buffer.enqueue(Request(addr, Request::Type::Read)));
+  }
+  CHECK(buffer.size() == 4);
+  CHECK(buffer.slots.capacity() == 4);
+
+  // A rejected request is left untouched
+  int num_called = 0;
+  Request rejected(Addr_t(0x40), Request::Type::Write, 0, [&num_called](Request&) { num_called++; });
+  CHECK(!buffer.enqueue(std::move(rejected)));
+  CHECK(buffer.size() == 4);
+  CHECK(rejected.addr == 0x40);
+  CHECK(rejected.callback);
+
+  // Removing and enqueueing recycles the slots in place
+  const ReqBuffer::Slot* slots = buffer.slots.data();
+  for (int i = 0; i < 100; i++) {
+    buffer.remove(buffer.begin());
+    CHECK(buffer.enqueue(Request(Addr_t(4 + i), Request::Type::Read)));
+  }
+  CHECK(buffer.size() == 4);
+  CHECK(buffer.slots.size() == 4);
+  CHECK(buffer.slots.data() == slots);
+  CHECK((get_addrs(buffer) == std::vector<Addr_t>{100, 101, 102, 103}));
+  CHECK(!buffer.enqueue(std::move(rejected)));
+}
+
+// Requests stay in arrival order when removed from the middle, and iterators to the others stay valid
+static void check_order() {
+  ReqBuffer buffer;
+  buffer.max_size = 8;
+  for (Addr_t addr = 0; addr < 6; addr++) {
+    buffer.enqueue(Request(addr, Request::Type::Read));
+  }
+  auto it_2 = std::next(buffer.begin(), 2);
+  auto it_4 = std::next(buffer.begin(), 4);
+  buffer.remove(std::next(buffer.begin(), 3));
+  buffer.remove(buffer.begin());
+  CHECK(it_2->addr == 2);
+  CHECK(it_4->addr == 4);
+  CHECK((get_addrs(buffer) == std::vector<Addr_t>{1, 2, 4, 5}));
+
+  buffer.enqueue(Request(Addr_t(6), Request::Type::Read));
+  CHECK(buffer.back().addr == 6);
+  buffer.remove(it_4);
+  buffer.remove(std::next(buffer.begin(), 3));
+  CHECK((get_addrs(buffer) == std::vector<Addr_t>{1, 2, 5}));
+  CHECK(buffer.back().addr == 5);
+
+  while (buffer.size() != 0) {
+    buffer.remove(buffer.begin());
+  }
+  CHECK(buffer.begin() == buffer.end());
+}
+
+// Removed requests do not keep whatever their callbacks captured alive
+static void check_callback_release() {
+  ReqBuffer buffer;
+  buffer.max_size = 2;
+  auto captured = std::make_shared<int>(0);
+  buffer.enqueue(Request(Addr_t(0), Request::Type::Read, 0, [captured](Request&) {}));
+  CHECK(captured.use_count() == 2);
+  buffer.remove(buffer.begin());
+  CHECK(captured.use_count() == 1);
+}
+
+int main() {
+  check_capacity();
+  check_order();
+  check_callback_release();
+  return AIM_CHECK_RESULT();
+}